@@ -0,0 +1,98 @@
+#include "util.hh"
+
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <string_view>
+
+using namespace std;
+using namespace std::chrono;
+
+constexpr size_t total = 1024 * 1024 * 1024;
+
+//! Keeps the checksums from being optimized away
+volatile uint32_t sink;
+
+//! The byte-at-a-time checksum that InternetChecksum used to compute
+class ReferenceChecksum {
+  private:
+    uint32_t _sum;
+    bool _parity{};
+
+  public:
+    ReferenceChecksum(const uint32_t initial_sum = 0) : _sum(initial_sum) {}
+
+    void add(string_view data) {
+        for (size_t i = 0; i < data.size(); i++) {
+            uint16_t val = uint8_t(data[i]);
+            if (not _parity) {
+                val <<= 8;
+            }
+            _sum += val;
+            _parity = !_parity;
+        }
+    }
+
+    uint16_t value() const {
+        uint32_t ret = _sum;
+        while (ret > 0xffff) {
+            ret = (ret >> 16) + (ret & 0xffff);
+        }
+        return ~ret;
+    }
+};
+
+//! \returns the throughput in Gbit/s of checksumming `total` bytes, `size` bytes at a time
+template <typename Checksum>
+double throughput(const string &data, const size_t offset, const size_t size, uint16_t &result) {
+    const string_view chunk = string_view(data).substr(offset, size);
+    const size_t rounds = total / size;
+    uint32_t sum = 0;
+
+    const auto start = steady_clock::now();
+    for (size_t i = 0; i < rounds; i++) {
+        Checksum check{sum & 0xff};
+        check.add(chunk);
+        sum += check.value();
+    }
+    const auto duration = duration_cast<nanoseconds>(steady_clock::now() - start).count();
+    sink = sum;
+
+    Checksum check;
+    check.add(chunk);
+    result = check.value();
+    return rounds * size * 8.0 / double(duration);
+}
+
+int main() {
+    try {
+        auto rd = get_random_generator();
+        string data(65536 + 1, 0);
+        for (auto &ch : data) {
+            ch = rd();
+        }
+
+        cout << fixed << setprecision(2);
+        for (const size_t size : {20, 40, 536, 1000, 1460, 9000, 65535}) {
+            for (const size_t offset : {0, 1}) {
+                uint16_t old_value = 0, new_value = 0;
+                const double old_rate = throughput<ReferenceChecksum>(data, offset, size, old_value);
+                const double new_rate = throughput<InternetChecksum>(data, offset, size, new_value);
+                if (old_value != new_value) {
+                    throw runtime_error("checksums differ for " + to_string(size) + " bytes");
+                }
+                cout << setw(5) << size << " bytes" << (offset ? " (unaligned)" : "            ") << ": "
+                     << setw(6) << old_rate << " -> " << setw(6) << new_rate << " Gbit/s (" << setw(5)
+                     << new_rate / old_rate << "x)\n";
+            }
+        }
+    } catch (const exception &e) {
+        cerr << e.what() << "\n";
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
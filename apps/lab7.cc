@@ -46,9 +46,9 @@ string summary(const EthernetFrame &frame) {
             if (dgram.parse(frame.payload().concatenate()) == ParseResult::NoError) {
                 ret += " " + dgram.header().summary();
                 if (dgram.header().proto == IPv4Header::PROTO_TCP) {
+                    // a parsed datagram's payload is one slice of the concatenated frame, so no second copy
                     TCPSegment tcp_seg;
-                    if (tcp_seg.parse(dgram.payload().concatenate(), dgram.header().pseudo_cksum()) ==
-                        ParseResult::NoError) {
+                    if (tcp_seg.parse(dgram.payload(), dgram.header().pseudo_cksum()) == ParseResult::NoError) {
                         ret += " " + tcp_seg.header().summary();
                     }
                 }
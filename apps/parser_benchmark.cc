@@ -0,0 +1,156 @@
+#include "arp_message.hh"
+#include "ethernet_frame.hh"
+#include "ipv4_datagram.hh"
+#include "tcp_segment.hh"
+
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using namespace std;
+using namespace std::chrono;
+
+constexpr size_t packets_per_run = 4'000'000;
+
+//! Keeps the results from being optimized away
+volatile size_t sink;
+
+//! \returns the frames in a pcap file with an Ethernet link type (the format tests/ipv4_parser.data uses)
+vector<Buffer> read_pcap(const string &filename) {
+    ifstream file{filename, ios::binary};
+    const string contents{istreambuf_iterator<char>(file), istreambuf_iterator<char>()};
+    if (not file.good() and not file.eof()) {
+        throw runtime_error("can't read " + filename);
+    }
+
+    // the file's byte order is whichever makes the magic number come out right
+    constexpr size_t file_header_len = 24, record_header_len = 16;
+    auto u32 = [&](const size_t offset, const bool swap) {
+        uint32_t val;
+        memcpy(&val, contents.data() + offset, sizeof(val));
+        return swap ? __builtin_bswap32(val) : val;
+    };
+    if (contents.size() < file_header_len or (u32(0, false) != 0xa1b2c3d4 and u32(0, true) != 0xa1b2c3d4)) {
+        throw runtime_error(filename + " isn't a pcap file");
+    }
+    const bool swap = u32(0, false) != 0xa1b2c3d4;
+    if (u32(20, swap) != 1) {
+        throw runtime_error(filename + " doesn't hold Ethernet frames");
+    }
+
+    vector<Buffer> frames;
+    for (size_t offset = file_header_len; offset + record_header_len <= contents.size();) {
+        const size_t caplen = u32(offset + 8, swap);
+        offset += record_header_len;
+        if (offset + caplen > contents.size()) {
+            break;
+        }
+        frames.emplace_back(contents.substr(offset, caplen));
+        offset += caplen;
+    }
+    return frames;
+}
+
+//! \returns the rate in millions of packets per second
+double rate(const size_t packets, const steady_clock::time_point start) {
+    const auto duration = duration_cast<nanoseconds>(steady_clock::now() - start).count();
+    return packets * 1000.0 / double(duration);
+}
+
+int main(int argc, char **argv) {
+    try {
+        if (argc != 2) {
+            cerr << "Usage: " << argv[0] << " PCAP_FILE (e.g. tests/ipv4_parser.data)\n";
+            return EXIT_FAILURE;
+        }
+
+        const vector<Buffer> frames = read_pcap(argv[1]);
+        if (frames.empty()) {
+            throw runtime_error("no frames in " + string(argv[1]));
+        }
+
+        // decode just the headers, which is all that the parser itself does
+        size_t checked = 0;
+        const auto header_start = steady_clock::now();
+        for (size_t i = 0; i < packets_per_run; i++) {
+            NetParser p{frames[i % frames.size()]};
+            EthernetHeader ethernet;
+            IPv4Header ip;
+            TCPHeader tcp;
+            if (ethernet.parse(p) == ParseResult::NoError and ethernet.type == EthernetHeader::TYPE_IPv4 and
+                ip.parse(p) == ParseResult::NoError and tcp.parse(p) == ParseResult::NoError) {
+                checked += tcp.doff;
+            }
+        }
+        const double header_rate = rate(packets_per_run, header_start);
+
+        // parse every frame down to its TCP segment or ARP message
+        size_t parsed = 0;
+        vector<pair<InternetDatagram, TCPSegment>> segments;
+        const auto parse_start = steady_clock::now();
+        for (size_t i = 0; i < packets_per_run; i++) {
+            EthernetFrame frame;
+            if (frame.parse(frames[i % frames.size()]) != ParseResult::NoError) {
+                continue;
+            }
+            if (frame.header().type == EthernetHeader::TYPE_ARP) {
+                ARPMessage arp;
+                parsed += arp.parse(frame.payload()) == ParseResult::NoError;
+                continue;
+            }
+
+            InternetDatagram dgram;
+            if (frame.header().type != EthernetHeader::TYPE_IPv4 or
+                dgram.parse(frame.payload()) != ParseResult::NoError) {
+                continue;
+            }
+            TCPSegment seg;
+            if (dgram.header().proto != IPv4Header::PROTO_TCP or
+                seg.parse(dgram.payload(), dgram.header().pseudo_cksum()) != ParseResult::NoError) {
+                continue;
+            }
+            parsed++;
+            checked += seg.header().doff;
+            if (i < frames.size()) {
+                segments.emplace_back(move(dgram), move(seg));
+            }
+        }
+        const double parse_rate = rate(packets_per_run, parse_start);
+        if (segments.empty()) {
+            throw runtime_error("no TCP segments in " + string(argv[1]));
+        }
+
+        // and serialize the TCP segments back into datagrams
+        size_t bytes = 0;
+        const auto serialize_start = steady_clock::now();
+        for (size_t i = 0; i < packets_per_run; i++) {
+            const auto &[dgram, seg] = segments[i % segments.size()];
+            InternetDatagram out;
+            out.header() = dgram.header();
+            out.payload() = seg.serialize(dgram.header().pseudo_cksum());
+            bytes += out.serialize().size();
+        }
+        const double serialize_rate = rate(packets_per_run, serialize_start);
+        sink = checked + bytes;
+
+        cout << fixed << setprecision(2);
+        cout << "parse headers only            : " << setw(6) << header_rate << " Mpackets/s\n";
+        cout << "parse Ethernet/IPv4/TCP or ARP: " << setw(6) << parse_rate << " Mpackets/s (" << parsed << " of "
+             << packets_per_run << " parsed)\n";
+        cout << "serialize TCP/IPv4            : " << setw(6) << serialize_rate << " Mpackets/s ("
+             << segments.size() << " distinct segments)\n";
+    } catch (const exception &e) {
+        cerr << e.what() << "\n";
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
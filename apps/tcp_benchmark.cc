@@ -11,8 +11,12 @@ using namespace std::chrono;
 
 constexpr size_t len = 100 * 1024 * 1024;
 
-void move_segments(TCPConnection &x, TCPConnection &y, vector<TCPSegment> &segments, const bool reorder) {
+//! \returns the number of pure ACKs (no payload, SYN or FIN) among the segments moved
+size_t move_segments(TCPConnection &x, TCPConnection &y, vector<TCPSegment> &segments, const bool reorder) {
+    size_t pure_acks = 0;
     while (not x.segments_out().empty()) {
+        const TCPSegment &seg = x.segments_out().front();
+        pure_acks += seg.length_in_sequence_space() == 0 and seg.header().ack;
         segments.emplace_back(move(x.segments_out().front()));
         x.segments_out().pop();
     }
@@ -26,10 +30,12 @@ void move_segments(TCPConnection &x, TCPConnection &y, vector<TCPSegment> &segme
         }
     }
     segments.clear();
+    return pure_acks;
 }
 
-void main_loop(const bool reorder) {
+void main_loop(const bool reorder, const bool delayed_ack) {
     TCPConfig config;
+    config.delayed_ack = delayed_ack;
     TCPConnection x{config}, y{config};
 
     string string_to_send(len, 'x');
@@ -42,6 +48,7 @@ void main_loop(const bool reorder) {
     y.end_input_stream();
 
     bool x_closed = false;
+    size_t acks = 0;
 
     string string_received;
     string_received.reserve(len);
@@ -67,7 +74,7 @@ void main_loop(const bool reorder) {
         // exchange segments between x and y but in reverse order
         vector<TCPSegment> segments;
         move_segments(x, y, segments, reorder);
-        move_segments(y, x, segments, false);
+        acks += move_segments(y, x, segments, false);
 
         // read output from y
         const auto available_output = y.inbound_stream().buffer_size();
@@ -95,8 +102,9 @@ void main_loop(const bool reorder) {
     const auto gigabits_per_second = len * 8.0 / double(duration);
 
     cout << fixed << setprecision(2);
-    cout << "CPU-limited throughput" << (reorder ? " with reordering: " : "                : ") << gigabits_per_second
-         << " Gbit/s\n";
+    cout << "CPU-limited throughput"
+         << (reorder ? " with reordering  : " : delayed_ack ? " with delayed ACKs: " : "                  : ")
+         << gigabits_per_second << " Gbit/s, " << acks << " ACKs\n";
 
     while (x.active() or y.active()) {
         loop();
@@ -105,8 +113,9 @@ void main_loop(const bool reorder) {
 
 int main() {
     try {
-        main_loop(false);
-        main_loop(true);
+        main_loop(false, false);
+        main_loop(false, true);
+        main_loop(true, false);
     } catch (const exception &e) {
         cerr << e.what() << "\n";
         return EXIT_FAILURE;
@@ -1,4 +1,5 @@
 #include "bidirectional_stream_copy.hh"
+#include "congestion_control.hh"
 #include "tcp_config.hh"
 #include "tcp_sponge_socket.hh"
 #include "tun.hh"
@@ -31,6 +32,12 @@ static void show_usage(const char *argv0, const char *msg) {
          << "\n\n"
 
          << "   -t <tmout>      Set rt_timeout to tmout                         " << TCPConfig::TIMEOUT_DFLT << "\n\n"
+         << "   -r <minrto>     Adapt the RTO to measured RTTs, min <minrto>    (fixed RTO)\n"
+         << "   -c <algo>       Congestion control: none, newreno, or cubic     none\n"
+         << "   -S              Use selective acknowledgments (SACK)            (no SACK)\n"
+         << "   -A <delay>      Delay ACKs by up to <delay> ms (RFC 1122)       (ACK every segment)\n"
+         << "   -N              Coalesce small writes (Nagle's algorithm)       (no delay)\n"
+         << "   -P              Probe for the path MTU (RFC 4821)               (no probing)\n\n"
 
          << "   -d <tundev>     Connect to tun <tundev>                         " << TUN_DFLT << "\n\n"
 
@@ -88,6 +95,35 @@ static tuple<TCPConfig, FdAdapterConfig, bool, char *> get_config(int argc, char
             c_fsm.rt_timeout = strtol(argv[curr + 1], nullptr, 0);
             curr += 2;
 
+        } else if (strncmp("-r", argv[curr], 3) == 0) {
+            check_argc(argc, argv, curr, "ERROR: -r requires one argument.");
+            c_fsm.adaptive_rto = true;
+            c_fsm.min_rto = strtol(argv[curr + 1], nullptr, 0);
+            curr += 2;
+
+        } else if (strncmp("-c", argv[curr], 3) == 0) {
+            check_argc(argc, argv, curr, "ERROR: -c requires one argument.");
+            c_fsm.congestion_control = congestion_control_from_name(argv[curr + 1]);
+            curr += 2;
+
+        } else if (strncmp("-S", argv[curr], 3) == 0) {
+            c_fsm.sack = true;
+            curr += 1;
+
+        } else if (strncmp("-A", argv[curr], 3) == 0) {
+            check_argc(argc, argv, curr, "ERROR: -A requires one argument.");
+            c_fsm.delayed_ack = true;
+            c_fsm.ack_delay = strtol(argv[curr + 1], nullptr, 0);
+            curr += 2;
+
+        } else if (strncmp("-N", argv[curr], 3) == 0) {
+            c_fsm.nagle = true;
+            curr += 1;
+
+        } else if (strncmp("-P", argv[curr], 3) == 0) {
+            c_fsm.pmtu_discovery = true;
+            curr += 1;
+
         } else if (strncmp("-d", argv[curr], 3) == 0) {
             check_argc(argc, argv, curr, "ERROR: -t requires one argument.");
             tundev = argv[curr + 1];
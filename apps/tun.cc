@@ -16,9 +16,9 @@ int main() {
     try {
         TunFD tun("tun144");
         while (true) {
-            auto buffer = tun.read();
+            Buffer buffer = tun.read_packet();
             cout << "\n\n***\n*** Got packet:\n***\n";
-            hexdump(buffer.data(), buffer.size());
+            hexdump(buffer.str().data(), buffer.size());
 
             IPv4Datagram ip_dgram;
 
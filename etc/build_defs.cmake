@@ -4,3 +4,8 @@ macro (add_sponge_exec exec_name)
     add_executable ("${exec_name}" "${exec_name}.cc")
     target_link_libraries ("${exec_name}" ${ARGN} sponge ${LIBPTHREAD})
 endmacro (add_sponge_exec)
+
+option (SPONGE_IO_URING "Build EventLoop::Backend::IOUring (needs Linux 6.0 or later, and its headers)" OFF)
+if (SPONGE_IO_URING)
+    add_definitions (-DSPONGE_IO_URING)
+endif ()
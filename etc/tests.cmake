@@ -17,6 +17,10 @@ add_test(NAME t_recv_special         COMMAND recv_special)
 add_test(NAME t_send_connect         COMMAND send_connect)
 add_test(NAME t_send_transmit        COMMAND send_transmit)
 add_test(NAME t_send_retx            COMMAND send_retx)
+add_test(NAME t_send_rtt             COMMAND send_rtt)
+add_test(NAME t_send_congestion      COMMAND send_congestion)
+add_test(NAME t_send_pmtud          COMMAND send_pmtud)
+add_test(NAME t_tcp_sack             COMMAND tcp_sack)
 add_test(NAME t_send_window          COMMAND send_window)
 add_test(NAME t_send_ack             COMMAND send_ack)
 add_test(NAME t_send_close           COMMAND send_close)
@@ -36,6 +40,12 @@ add_test(NAME t_byte_stream_one_write    COMMAND byte_stream_one_write)
 add_test(NAME t_byte_stream_two_writes   COMMAND byte_stream_two_writes)
 add_test(NAME t_byte_stream_capacity     COMMAND byte_stream_capacity)
 add_test(NAME t_byte_stream_many_writes  COMMAND byte_stream_many_writes)
+add_test(NAME t_byte_stream_chunked     COMMAND byte_stream_chunked)
+add_test(NAME t_buffer_slice            COMMAND buffer_slice)
+add_test(NAME t_internet_checksum       COMMAND internet_checksum)
+add_test(NAME t_packet_headroom         COMMAND packet_headroom)
+add_test(NAME t_packet_pool             COMMAND packet_pool)
+add_test(NAME t_event_loop              COMMAND event_loop)
 
 add_test(NAME t_webget               COMMAND "${PROJECT_SOURCE_DIR}/tests/webget_t.sh")
 
@@ -56,6 +66,11 @@ add_test(NAME t_connect              COMMAND fsm_connect_relaxed)
 add_test(NAME ec_listen              COMMAND fsm_listen)
 add_test(NAME t_listen               COMMAND fsm_listen_relaxed)
 add_test(NAME t_winsize              COMMAND fsm_winsize)
+add_test(NAME t_winscale             COMMAND fsm_winscale)
+add_test(NAME t_mss                  COMMAND fsm_mss)
+add_test(NAME t_delayed_ack          COMMAND fsm_delayed_ack)
+add_test(NAME t_nagle                COMMAND fsm_nagle)
+add_test(NAME t_header_prediction    COMMAND fsm_header_prediction)
 add_test(NAME ec_retx                COMMAND fsm_retx)
 add_test(NAME t_retx                 COMMAND fsm_retx_relaxed)
 add_test(NAME t_retx_win             COMMAND fsm_retx_win)
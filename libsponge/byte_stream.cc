@@ -2,6 +2,7 @@
 
 #include <algorithm>
 #include <cstddef>
+#include <stdexcept>
 
 // Dummy implementation of a flow-controlled in-memory byte stream.
 
@@ -15,11 +16,14 @@ void DUMMY_CODE(Targs &&... /* unused */) {}
 
 using namespace std;
 
-ByteStream::ByteStream(const size_t capacity)
-    : _buffer(capacity)
+//! \param[in] capacity the maximum number of unread bytes the stream will hold
+//! \param[in] storage whether to keep bytes in a circular buffer or as a queue of shared chunks
+ByteStream::ByteStream(const size_t capacity, const Storage storage)
+    : _storage(storage)
+    , _buffer(storage == Storage::Ring ? capacity : 0)
     , _capacity(capacity)
     , _unread_idx(0)
-    , _unassem_idx(0)
+    , _unread_len(0)
     , _eif(false)
     , _eof(false)
     , _total_write(0)
@@ -27,34 +31,141 @@ ByteStream::ByteStream(const size_t capacity)
     DUMMY_CODE(capacity);
 }
 
-size_t ByteStream::write(const string &data) {
-    size_t need_write = data.size();
-    if (_capacity - _unassem_idx < need_write) {
-        copy(_buffer.begin() + _unread_idx, _buffer.begin() + _unassem_idx, _buffer.begin());
-        _unassem_idx -= _unread_idx;
-        _unread_idx = 0;
+pair<string_view, string_view> ByteStream::readable_spans(const size_t len) const {
+    const size_t span_len = min(len, _unread_len);
+    const size_t first_len = min(span_len, _capacity - _unread_idx);
+    if (span_len == 0) {
+        return {};
+    }
+    return {{&_buffer[_unread_idx], first_len}, {_buffer.data(), span_len - first_len}};
+}
+
+//! \details With Storage::Ring, new bytes go right after the last unread byte, wrapping
+//! around to the front of the storage, so nothing already stored is ever moved.
+size_t ByteStream::write_view(string_view data) {
+    const size_t write_len = min(data.size(), remaining_capacity());
+    if (write_len == 0) {
+        return 0;
+    }
+    if (_storage == Storage::Chunked) {
+        _chunks.emplace_back(string(data.substr(0, write_len)));
+    } else {
+        ring_copy(0, data.substr(0, write_len));
     }
-    size_t write_len = min(data.size(), _capacity - _unassem_idx);
-    copy(data.begin(), data.begin() + write_len, _buffer.begin() + _unassem_idx);
-    _unassem_idx += write_len;
+    _unread_len += write_len;
+    _total_write += write_len;
+    return write_len;
+}
+
+void ByteStream::ring_copy(const size_t offset, string_view data) {
+    const size_t write_idx = (_unread_idx + _unread_len + offset) % _capacity;
+    const size_t first_len = min(data.size(), _capacity - write_idx);
+    copy(data.begin(), data.begin() + first_len, _buffer.begin() + write_idx);
+    copy(data.begin() + first_len, data.end(), _buffer.begin());
+}
+
+//! \param[in] offset how far past the last written byte the first byte of `data` belongs
+//! \param[in] data the bytes to store
+//! \details The bytes land in the ring exactly where write() would eventually put them, so
+//! commit_ahead() only has to advance the end of the readable region.
+size_t ByteStream::store_ahead(const size_t offset, string_view data) {
+    if (_storage != Storage::Ring) {
+        throw runtime_error("ByteStream::store_ahead requires Storage::Ring");
+    }
+    if (offset >= remaining_capacity()) {
+        return 0;
+    }
+    const size_t store_len = min(data.size(), remaining_capacity() - offset);
+    ring_copy(offset, data.substr(0, store_len));
+    return store_len;
+}
+
+//! \param[in] len the number of stored-ahead bytes to append to the readable region
+void ByteStream::commit_ahead(const size_t len) {
+    if (len > remaining_capacity()) {
+        throw out_of_range("ByteStream::commit_ahead");
+    }
+    _unread_len += len;
+    _total_write += len;
+}
+
+size_t ByteStream::write(const string &data) { return write_view(data); }
+
+//! \details A string whose allocation is mostly unused (e.g. one filled by a short read) is
+//! copied instead, so that small writes can't pin down much more memory than `capacity`.
+size_t ByteStream::write(string &&data) {
+    if (_storage == Storage::Ring or data.capacity() > 2 * data.size()) {
+        return write_view(data);
+    }
+    data.resize(min(data.size(), remaining_capacity()));
+    return write(Buffer(move(data)));
+}
+
+size_t ByteStream::write(Buffer data) {
+    const size_t write_len = data.size();
+    if (_storage == Storage::Ring or write_len == 0 or write_len > remaining_capacity()) {
+        return write_view(data);
+    }
+    _chunks.push_back(move(data));
+    _unread_len += write_len;
     _total_write += write_len;
     return write_len;
 }
 
 //! \param[in] len bytes will be copied from the output side of the buffer
 string ByteStream::peek_output(const size_t len) const {
-    size_t read_len = min(len, _unassem_idx - _unread_idx);
-    if (read_len == 0) {
-        return {};
+    string ret;
+    if (_storage == Storage::Chunked) {
+        ret.reserve(min(len, _unread_len));
+        for (auto it = _chunks.begin(); it != _chunks.end() and ret.size() < len; ++it) {
+            ret.append(it->str().substr(0, len - ret.size()));
+        }
+        return ret;
+    }
+    const auto [first, second] = readable_spans(len);
+    ret.reserve(first.size() + second.size());
+    ret.append(first);
+    ret.append(second);
+    return ret;
+}
+
+//! \param[in] len bytes will be exposed from the output side of the buffer
+BufferViewList ByteStream::peek_views(const size_t len) const {
+    BufferViewList ret;
+    if (_storage == Storage::Chunked) {
+        size_t remaining = len;
+        for (auto it = _chunks.begin(); it != _chunks.end() and remaining > 0; ++it) {
+            const auto view = it->str().substr(0, remaining);
+            ret.append(view);
+            remaining -= view.size();
+        }
+        return ret;
     }
-    string ret(&_buffer[_unread_idx], &_buffer[_unread_idx + read_len]);
+    const auto [first, second] = readable_spans(len);
+    ret.append(first);
+    ret.append(second);
     return ret;
 }
 
 //! \param[in] len bytes will be removed from the output side of the buffer
 void ByteStream::pop_output(const size_t len) {
-    size_t pop_len = min(len, _unassem_idx - _unread_idx);
-    _unread_idx += pop_len;
+    size_t pop_len = min(len, _unread_len);
+    if (_storage == Storage::Chunked) {
+        for (size_t remaining = pop_len; remaining > 0;) {
+            if (remaining < _chunks.front().size()) {
+                _chunks.front().remove_prefix(remaining);
+                break;
+            }
+            remaining -= _chunks.front().size();
+            _chunks.pop_front();
+        }
+    } else {
+        _unread_idx += pop_len;
+        if (_unread_idx >= _capacity) {
+            _unread_idx -= _capacity;
+        }
+    }
+    _unread_len -= pop_len;
     _total_read += pop_len;
     if (buffer_empty() && _eif) {
         _eof = true;
@@ -64,15 +175,29 @@ void ByteStream::pop_output(const size_t len) {
 //! \param[in] len bytes will be popped and returned
 //! \returns a string
 std::string ByteStream::read(const size_t len) {
-    size_t read_len = min(len, _unassem_idx - _unread_idx);
-    if (read_len == 0)
-        return {};
-    string ret(&_buffer[_unread_idx], &_buffer[_unread_idx + read_len]);
-    _unread_idx += read_len;
-    _total_read += read_len;
-    if (buffer_empty() && _eif) {
-        _eof = true;
+    string ret = peek_output(len);
+    pop_output(ret.size());
+    return ret;
+}
+
+//! \param[in] len bytes will be popped and returned
+//! \details With Storage::Chunked, nothing is copied: the BufferList holds the chunks, or a leading
+//! slice of the chunk that `len` splits.
+BufferList ByteStream::read_buffers(const size_t len) {
+    if (_storage == Storage::Ring) {
+        return read(len);
+    }
+    BufferList ret;
+    size_t remaining = min(len, _unread_len);
+    for (auto it = _chunks.begin(); remaining > 0; ++it) {
+        if (remaining < it->size()) {
+            ret.append(it->substr(0, remaining));
+            break;
+        }
+        ret.append(*it);
+        remaining -= it->size();
     }
+    pop_output(ret.size());
     return ret;
 }
 
@@ -85,9 +210,9 @@ void ByteStream::end_input() {
 
 bool ByteStream::input_ended() const { return _eif; }
 
-size_t ByteStream::buffer_size() const { return _unassem_idx - _unread_idx; }
+size_t ByteStream::buffer_size() const { return _unread_len; }
 
-bool ByteStream::buffer_empty() const { return _unread_idx == _unassem_idx; }
+bool ByteStream::buffer_empty() const { return _unread_len == 0; }
 
 bool ByteStream::eof() const { return _eof; }
 
@@ -95,4 +220,4 @@ size_t ByteStream::bytes_written() const { return _total_write; }
 
 size_t ByteStream::bytes_read() const { return _total_read; }
 
-size_t ByteStream::remaining_capacity() const { return _capacity - (_unassem_idx - _unread_idx); }
+size_t ByteStream::remaining_capacity() const { return _capacity - _unread_len; }
@@ -1,8 +1,13 @@
 #ifndef SPONGE_LIBSPONGE_BYTE_STREAM_HH
 #define SPONGE_LIBSPONGE_BYTE_STREAM_HH
 
+#include "buffer.hh"
+
 #include <cstddef>
+#include <deque>
 #include <string>
+#include <string_view>
+#include <utility>
 #include <vector>
 
 //! \brief An in-order byte stream.
@@ -11,6 +16,13 @@
 //! side.  The byte stream is finite: the writer can end the input,
 //! and then no more bytes can be written.
 class ByteStream {
+  public:
+    //! How the stream keeps the bytes that have been written but not yet read
+    enum class Storage {
+        Ring,    //!< A fixed circular buffer of `capacity` bytes; every write is copied in
+        Chunked  //!< A queue of reference-counted Buffers; owned writes are stored without a copy
+    };
+
   private:
     // Your code here -- add private members as necessary.
 
@@ -20,18 +32,29 @@ class ByteStream {
     // different approaches.
 
     bool _error{};  //!< Flag indicating that the stream suffered an error.
-    std::vector<char> _buffer;
+    Storage _storage;
+    std::vector<char> _buffer;     //!< Circular storage (Storage::Ring); bytes are never moved once written
+    std::deque<Buffer> _chunks{};  //!< Unread chunks, oldest first (Storage::Chunked)
     size_t _capacity;
-    size_t _unread_idx;
-    size_t _unassem_idx;
+    size_t _unread_idx;  //!< Position of the first unread byte in `_buffer`
+    size_t _unread_len;  //!< Number of unread bytes, which may wrap past the end of `_buffer`
     bool _eif;
     bool _eof;
     size_t _total_write;
     size_t _total_read;
 
+    //! The next `len` unread bytes as (at most) two contiguous spans of `_buffer`
+    std::pair<std::string_view, std::string_view> readable_spans(const size_t len) const;
+
+    //! Copy as much of `data` as fits into the stream
+    size_t write_view(std::string_view data);
+
+    //! Copy `data` into `_buffer`, starting `offset` bytes past the last unread byte (Storage::Ring)
+    void ring_copy(const size_t offset, std::string_view data);
+
   public:
     //! Construct a stream with room for `capacity` bytes.
-    ByteStream(const size_t capacity);
+    ByteStream(const size_t capacity, const Storage storage = Storage::Ring);
 
     //! \name "Input" interface for the writer
     //!@{
@@ -41,6 +64,24 @@ class ByteStream {
     //! \returns the number of bytes accepted into the stream
     size_t write(const std::string &data);
 
+    //! Write a string of bytes into the stream, taking ownership of it.
+    //! \note With Storage::Chunked the string is kept as-is, without copying.
+    //! \returns the number of bytes accepted into the stream
+    size_t write(std::string &&data);
+
+    //! Write a Buffer into the stream, sharing its storage.
+    //! \note With Storage::Chunked a Buffer that fits entirely is kept without copying.
+    //! \returns the number of bytes accepted into the stream
+    size_t write(Buffer data);
+
+    //! Store bytes `offset` bytes past the end of the stream without making them readable yet.
+    //! Stores as many as fit in the remaining capacity. Only supported with Storage::Ring.
+    //! \returns the number of bytes stored
+    size_t store_ahead(const size_t offset, std::string_view data);
+
+    //! Make the next `len` bytes previously placed by store_ahead() readable, as if written
+    void commit_ahead(const size_t len);
+
     //! \returns the number of additional bytes that the stream has space for
     size_t remaining_capacity() const;
 
@@ -58,6 +99,10 @@ class ByteStream {
     //! \returns a string
     std::string peek_output(const size_t len) const;
 
+    //! Peek at next "len" bytes of the stream without copying them
+    //! \returns at most two views into the stream's storage, valid until the next write or pop
+    BufferViewList peek_views(const size_t len) const;
+
     //! Remove bytes from the buffer
     void pop_output(const size_t len);
 
@@ -65,6 +110,10 @@ class ByteStream {
     //! \returns a string
     std::string read(const size_t len);
 
+    //! Read (i.e., detach and then pop) the next "len" bytes of the stream
+    //! \returns a BufferList whose Buffers share storage with the stored chunks (Storage::Chunked)
+    BufferList read_buffers(const size_t len);
+
     //! \returns `true` if the stream input has ended
     bool input_ended() const;
 
@@ -0,0 +1,134 @@
+#include "congestion_control.hh"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <stdexcept>
+
+using namespace std;
+
+//! \param[in] mss the sender's maximum segment size
+//! \details The initial window is min(4 * MSS, max(2 * MSS, 4380 bytes)); ssthresh starts out arbitrarily high.
+CongestionController::CongestionController(const size_t mss)
+    : _mss(mss), _cwnd(min(4 * mss, max(2 * mss, size_t{4380}))), _ssthresh(SIZE_MAX) {}
+
+void CongestionController::slow_start(const size_t bytes_acked) { _cwnd += min(bytes_acked, _mss); }
+
+void CongestionController::deflate(const size_t bytes_acked) {
+    _cwnd -= min(bytes_acked, _cwnd);
+    if (bytes_acked >= _mss) {
+        _cwnd += _mss;
+    }
+}
+
+void CongestionController::exit_recovery(const size_t bytes_in_flight) {
+    _cwnd = min(_ssthresh, max(bytes_in_flight, _mss) + _mss);
+}
+
+void NewRenoController::on_ack(const size_t bytes_acked, const size_t /* now */, const optional<double> /* srtt */) {
+    if (in_slow_start()) {
+        slow_start(bytes_acked);
+        return;
+    }
+    // congestion avoidance: one MSS per cwnd of acknowledged data (appropriate byte counting)
+    _bytes_acked += bytes_acked;
+    if (_bytes_acked >= _cwnd) {
+        _bytes_acked -= _cwnd;
+        _cwnd += _mss;
+    }
+}
+
+void NewRenoController::on_loss(const size_t bytes_in_flight, const size_t /* now */) {
+    _ssthresh = max(bytes_in_flight / 2, 2 * _mss);
+    _cwnd = _ssthresh;
+    _bytes_acked = 0;
+}
+
+void NewRenoController::on_timeout(const size_t bytes_in_flight, const size_t /* now */) {
+    _ssthresh = max(bytes_in_flight / 2, 2 * _mss);
+    _cwnd = _mss;
+    _bytes_acked = 0;
+}
+
+double CubicController::w_cubic(const double t) const { return C * pow(t - _k, 3) * _mss + _w_max; }
+
+void CubicController::reduce() {
+    const auto cwnd = static_cast<double>(_cwnd);
+    // fast convergence: release bandwidth to newer flows if the window stopped short of the last W_max
+    _w_max = cwnd < _w_max ? cwnd * (1 + BETA) / 2 : cwnd;
+    _ssthresh = max(static_cast<size_t>(cwnd * BETA), 2 * _mss);
+    _epoch_start.reset();
+    _growth = 0;
+}
+
+//! \details Without an RTT sample the window is aimed at W(t) rather than W(t + RTT).
+void CubicController::on_ack(const size_t bytes_acked, const size_t now, const optional<double> srtt) {
+    if (in_slow_start()) {
+        slow_start(bytes_acked);
+        return;
+    }
+
+    const auto cwnd = static_cast<double>(_cwnd);
+    if (not _epoch_start.has_value()) {
+        _epoch_start = now;
+        _k = _w_max > cwnd ? cbrt((_w_max - cwnd) / _mss / C) : 0;
+        _w_max = max(_w_max, cwnd);
+        _w_est = cwnd;
+    }
+    const double t = static_cast<double>(now - _epoch_start.value()) / 1000;
+    const double rtt = srtt.value_or(0) / 1000;
+
+    // the Reno-friendly estimate grows like Reno with the same average window (RFC 9438, section 4.3)
+    const double alpha = _w_est < _w_max ? 3 * (1 - BETA) / (1 + BETA) : 1;
+    _w_est += alpha * static_cast<double>(bytes_acked) * _mss / cwnd;
+
+    double increase = 0;
+    if (w_cubic(t) < _w_est) {
+        increase = _w_est - cwnd;
+    } else {
+        const double target = clamp(w_cubic(t + rtt), cwnd, 1.5 * cwnd);
+        increase = (target - cwnd) / cwnd * static_cast<double>(bytes_acked);
+    }
+    _growth += max(increase, 0.0);
+    const double whole = floor(_growth);
+    _cwnd += static_cast<size_t>(whole);
+    _growth -= whole;
+}
+
+void CubicController::on_loss(const size_t /* bytes_in_flight */, const size_t /* now */) {
+    reduce();
+    _cwnd = _ssthresh;
+}
+
+void CubicController::on_timeout(const size_t /* bytes_in_flight */, const size_t /* now */) {
+    reduce();
+    _cwnd = _mss;
+}
+
+//! \param[in] algorithm which algorithm to use
+//! \param[in] mss the sender's maximum segment size
+unique_ptr<CongestionController> make_congestion_controller(const TCPConfig::CongestionControl algorithm,
+                                                            const size_t mss) {
+    switch (algorithm) {
+        case TCPConfig::CongestionControl::NewReno:
+            return make_unique<NewRenoController>(mss);
+        case TCPConfig::CongestionControl::Cubic:
+            return make_unique<CubicController>(mss);
+        case TCPConfig::CongestionControl::None:
+            break;
+    }
+    return nullptr;
+}
+
+TCPConfig::CongestionControl congestion_control_from_name(const string &name) {
+    if (name == "none") {
+        return TCPConfig::CongestionControl::None;
+    }
+    if (name == "newreno" or name == "reno") {
+        return TCPConfig::CongestionControl::NewReno;
+    }
+    if (name == "cubic") {
+        return TCPConfig::CongestionControl::Cubic;
+    }
+    throw runtime_error("unknown congestion-control algorithm: " + name);
+}
@@ -0,0 +1,124 @@
+#ifndef SPONGE_LIBSPONGE_CONGESTION_CONTROL_HH
+#define SPONGE_LIBSPONGE_CONGESTION_CONTROL_HH
+
+#include "tcp_config.hh"
+
+#include <cstddef>
+#include <memory>
+#include <optional>
+#include <string>
+
+//! \brief Interface to a sender-side congestion-control algorithm
+
+//! The TCPSender reports ACKs, losses and retransmission timeouts, and
+//! never lets more than cwnd() bytes (in sequence space) be in flight.
+//! Window sizes are in bytes; times are the sender's clock, in milliseconds.
+class CongestionController {
+  protected:
+    size_t _mss;       //!< Sender's maximum segment size
+    size_t _cwnd;      //!< Congestion window
+    size_t _ssthresh;  //!< Slow-start threshold
+
+    //! Slow-start growth: one MSS per ACK, at most ([RFC 5681](\ref rfc::rfc5681), section 3.1)
+    void slow_start(const size_t bytes_acked);
+
+  public:
+    //! Start in slow start with the initial window of [RFC 5681](\ref rfc::rfc5681), section 3.1
+    explicit CongestionController(const size_t mss);
+    virtual ~CongestionController() = default;
+
+    //! \brief New data was acknowledged
+    //! \param[in] bytes_acked how much of the sequence space the ACK covered for the first time
+    //! \param[in] now the sender's current time
+    //! \param[in] srtt the smoothed round-trip time, if it has been measured yet
+    virtual void on_ack(const size_t bytes_acked, const size_t now, const std::optional<double> srtt) = 0;
+
+    //! \brief A loss was inferred while the ACK clock is still running (e.g. from duplicate ACKs)
+    virtual void on_loss(const size_t bytes_in_flight, const size_t now) = 0;
+
+    //! \brief The retransmission timer expired
+    virtual void on_timeout(const size_t bytes_in_flight, const size_t now) = 0;
+
+    //! \brief Name of the algorithm
+    virtual std::string name() const = 0;
+
+    //! \name Fast recovery ([RFC 6582](\ref rfc::rfc6582)), driven by the sender after on_loss()
+    //!@{
+
+    //! Grow the window by `bytes`, once for the three duplicate ACKs and then by one MSS per further one
+    void inflate(const size_t bytes) { _cwnd += bytes; }
+
+    //! A partial ACK: take back what it acknowledged, plus one MSS if that was at least one MSS
+    void deflate(const size_t bytes_acked);
+
+    //! A full ACK ends recovery: cwnd = min(ssthresh, max(flight size, MSS) + MSS)
+    void exit_recovery(const size_t bytes_in_flight);
+    //!@}
+
+    //! The segment size changed (path MTU discovery); the window, in bytes, stays as it is
+    void set_mss(const size_t mss) { _mss = mss; }
+
+    //! \name Accessors
+    //!@{
+    size_t cwnd() const { return _cwnd; }
+    size_t ssthresh() const { return _ssthresh; }
+    size_t mss() const { return _mss; }
+    bool in_slow_start() const { return _cwnd < _ssthresh; }
+    //!@}
+};
+
+//! \brief Reno-style congestion control ([RFC 5681](\ref rfc::rfc5681))
+
+//! Slow start below ssthresh, then one MSS of growth per window's worth of
+//! acknowledged bytes. A loss halves the flight size; a timeout also drops
+//! the window to one segment.
+class NewRenoController : public CongestionController {
+    size_t _bytes_acked{0};  //!< Acknowledged bytes not yet credited in congestion avoidance
+
+  public:
+    using CongestionController::CongestionController;
+
+    void on_ack(const size_t bytes_acked, const size_t now, const std::optional<double> srtt) override;
+    void on_loss(const size_t bytes_in_flight, const size_t now) override;
+    void on_timeout(const size_t bytes_in_flight, const size_t now) override;
+    std::string name() const override { return "newreno"; }
+};
+
+//! \brief CUBIC congestion control ([RFC 9438](\ref rfc::rfc9438))
+
+//! In congestion avoidance the window follows W(t) = C * (t - K)^3 + W_max,
+//! where t is the time since the last reduction, but never grows slower than
+//! the Reno-friendly estimate W_est.
+class CubicController : public CongestionController {
+    static constexpr double C = 0.4;     //!< Scaling constant, in segments per second cubed
+    static constexpr double BETA = 0.7;  //!< Multiplicative decrease factor
+
+    double _w_max{0};                      //!< Window just before the last reduction, in bytes
+    double _w_est{0};                      //!< Reno-friendly window estimate, in bytes
+    double _k{0};                          //!< Time for W(t) to return to W_max, in seconds
+    double _growth{0};                     //!< Fractional bytes of window growth not yet applied
+    std::optional<size_t> _epoch_start{};  //!< When the current congestion-avoidance epoch began
+
+    //! Cubic window W(t) at `t` seconds into the epoch, in bytes
+    double w_cubic(const double t) const;
+
+    //! Shrink the window after a congestion event and start a new epoch
+    void reduce();
+
+  public:
+    using CongestionController::CongestionController;
+
+    void on_ack(const size_t bytes_acked, const size_t now, const std::optional<double> srtt) override;
+    void on_loss(const size_t bytes_in_flight, const size_t now) override;
+    void on_timeout(const size_t bytes_in_flight, const size_t now) override;
+    std::string name() const override { return "cubic"; }
+};
+
+//! \brief Construct the controller for `algorithm`, or nullptr for TCPConfig::CongestionControl::None
+std::unique_ptr<CongestionController> make_congestion_controller(const TCPConfig::CongestionControl algorithm,
+                                                                 const size_t mss);
+
+//! \brief Parse an algorithm name ("none", "newreno" or "reno", "cubic"); throws on unknown names
+TCPConfig::CongestionControl congestion_control_from_name(const std::string &name);
+
+#endif  // SPONGE_LIBSPONGE_CONGESTION_CONTROL_HH
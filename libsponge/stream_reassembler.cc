@@ -1,8 +1,7 @@
 #include "stream_reassembler.hh"
 
+#include <algorithm>
 #include <cstddef>
-#include <utility>
-#include <vector>
 
 // Dummy implementation of a stream reassembler.
 
@@ -16,78 +15,130 @@ void DUMMY_CODE(Targs &&... /* unused */) {}
 
 using namespace std;
 
+//! \returns a word with bits [bit, bit + n) set
+static inline uint64_t bit_mask(const size_t bit, const size_t n) {
+    return (n == 64 ? ~uint64_t(0) : ((uint64_t(1) << n) - 1)) << bit;
+}
+
 StreamReassembler::StreamReassembler(const size_t capacity)
-    : _output(capacity), _capacity(capacity), _expect(0), _unassem_string(), _eif(false), _end_idx(0) {}
+    : _output(capacity)
+    , _capacity(capacity)
+    , _expect(0)
+    , _received((capacity + 63) / 64)
+    , _unassem_bytes(0)
+    , _eif(false)
+    , _end_idx(0) {}
 
 //! \details This function accepts a substring (aka a segment) of bytes,
 //! possibly out-of-order, from the logical stream, and assembles any newly
 //! contiguous substrings and writes them into the output stream in order.
-void StreamReassembler::push_substring(const string &data, const size_t index, const bool eof) {
-    if (index + data.size() < _expect) {
-        return;
-    }
-    if (data.size() > _unassem_string[index].size()) {
-        _unassem_string[index] = data;
-    }
+//!
+//! Bytes that fit in the window (from the next unassembled byte up to the first byte that
+//! would not fit in the output stream) are copied straight to their final place in the
+//! output's storage, and marked in `_received`. Once the hole in front of them fills,
+//! assembling them just makes that part of the output readable.
+void StreamReassembler::push_substring(string_view data, const size_t index, const bool eof) {
     if (eof) {
         _eif = true;
         _end_idx = index + data.size();
     }
+
+    const size_t window_end = _output.bytes_read() + _capacity;
+    const size_t begin = max(index, _expect);
+    const size_t end = min(index + data.size(), window_end);
+    if (begin < end) {
+        const auto new_bytes = data.substr(begin - index, end - begin);
+        if (begin == _expect and _unassem_bytes == 0) {
+            // in order with nothing stored ahead: no bookkeeping needed
+            _expect += _output.store_ahead(0, new_bytes);
+            _output.commit_ahead(new_bytes.size());
+        } else {
+            _output.store_ahead(begin - _expect, new_bytes);
+            _unassem_bytes += mark_received(begin, end);
+        }
+    }
+
     assemble();
 }
 
-void StreamReassembler::assemble() {
-    vector<size_t> assemed_node;
-    pair<bool, pair<size_t, string>> remain_string{false, {}};
-    for (auto &node : _unassem_string) {
-        auto idx = node.first;
-        auto &sub_string = node.second;
-        if (idx > _expect)
-            break;
+size_t StreamReassembler::mark_received(const size_t begin, const size_t end) {
+    size_t newly_set = 0;
+    size_t pos = begin % _capacity;
+    for (size_t remaining = end - begin; remaining > 0;) {
+        const size_t bit = pos % 64;
+        const size_t n = min({64 - bit, remaining, _capacity - pos});
+        const uint64_t mask = bit_mask(bit, n);
+        uint64_t &word = _received[pos / 64];
+        newly_set += __builtin_popcountll(mask & ~word);
+        word |= mask;
+        remaining -= n;
+        pos = pos + n == _capacity ? 0 : pos + n;
+    }
+    return newly_set;
+}
 
-        if (idx + sub_string.size() > _expect) {
-            auto write_idx = _expect - idx;
-            auto write_string = sub_string.substr(write_idx);
-            if (_output.remaining_capacity() >= write_string.size()) {
-                _output.write(write_string);
-                _expect += write_string.size();
-            } else {
-                auto sub_write_string = write_string.substr(0, _output.remaining_capacity());
-                auto write_len = sub_write_string.size();
-                _output.write(sub_write_string);
-                _expect += write_len;
-                remain_string = make_pair(true, make_pair(idx + write_len, write_string.substr(write_len)));
-            }
+size_t StreamReassembler::take_received_run() {
+    if (_unassem_bytes == 0) {
+        return 0;
+    }
+    const size_t limit = _output.remaining_capacity();
+    size_t run = 0;
+    size_t pos = _expect % _capacity;
+    while (run < limit) {
+        const size_t bit = pos % 64;
+        const size_t avail = min({64 - bit, limit - run, _capacity - pos});
+        uint64_t &word = _received[pos / 64];
+        const uint64_t unset = ~word >> bit;
+        const size_t n = unset == 0 ? avail : min(avail, size_t(__builtin_ctzll(unset)));
+        word &= ~bit_mask(bit, n);
+        run += n;
+        pos = pos + n == _capacity ? 0 : pos + n;
+        if (n < avail) {
+            break;
         }
-        assemed_node.push_back(idx);
     }
+    return run;
+}
+
+void StreamReassembler::assemble() {
+    const size_t run = take_received_run();
+    _output.commit_ahead(run);
+    _expect += run;
+    _unassem_bytes -= run;
 
     if (_eif && _expect >= _end_idx) {
         _output.end_input();
     }
-    for (auto idx : assemed_node) {
-        _unassem_string.erase(idx);
-    }
-    if (remain_string.first) {
-        _unassem_string[remain_string.second.first] = remain_string.second.second;
+}
+
+size_t StreamReassembler::find_bit(size_t index, const bool set) const {
+    const size_t window_end = _output.bytes_read() + _capacity;
+    while (index < window_end) {
+        const size_t pos = index % _capacity;
+        const size_t bit = pos % 64;
+        const size_t avail = min({64 - bit, window_end - index, _capacity - pos});
+        const uint64_t word = (set ? _received[pos / 64] : ~_received[pos / 64]) >> bit;
+        if (word != 0 and size_t(__builtin_ctzll(word)) < avail) {
+            return index + __builtin_ctzll(word);
+        }
+        index += avail;
     }
+    return window_end;
 }
 
-size_t StreamReassembler::unassembled_bytes() const {
-    size_t ret(0);
-    size_t b(0), e(0);
-    for (auto &node : _unassem_string) {
-        auto idx = node.first;
-        const auto &sub_string = node.second;
+size_t StreamReassembler::unassembled_bytes() const { return _unassem_bytes; }
 
-        if (idx > e) {
-            ret += e - b;
-            b = idx;
-        }
-        e = max(e, idx + sub_string.size());
+vector<pair<uint64_t, uint64_t>> StreamReassembler::unassembled_ranges() const {
+    vector<pair<uint64_t, uint64_t>> ranges;
+    size_t found = 0;
+    for (size_t index = _expect; found < _unassem_bytes;) {
+        const size_t begin = find_bit(index, true);
+        const size_t end = find_bit(begin, false);
+        ranges.emplace_back(begin, end);
+        found += end - begin;
+        index = end;
     }
-    ret += e - b;
-    return ret;
+    return ranges;
 }
 
-bool StreamReassembler::empty() const { return _output.buffer_empty(); }
+bool StreamReassembler::empty() const { return _unassem_bytes == 0; }
@@ -5,8 +5,8 @@
 
 #include <cstddef>
 #include <cstdint>
-#include <map>
-#include <string>
+#include <string_view>
+#include <utility>
 #include <vector>
 
 //! \brief A class that assembles a series of excerpts from a byte stream (possibly out of order,
@@ -17,13 +17,28 @@ class StreamReassembler {
 
     ByteStream _output;  //!< The reassembled in-order byte stream
     size_t _capacity;    //!< The maximum number of bytes
-    size_t _expect;
-    std::map<size_t, std::string> _unassem_string;
+    size_t _expect;      //!< Index of the next byte to be written to `_output`
+    //! One bit per byte of the window, set once the byte has been stored ahead in `_output`.
+    //! Bit `i % _capacity` stands for stream index `i`, matching the byte's place in the output ring.
+    std::vector<uint64_t> _received;
+    size_t _unassem_bytes;  //!< Number of bits set in `_received`
     bool _eif;
     size_t _end_idx;
 
+    //! Set the bits for stream indices [begin, end)
+    //! \returns how many of them were not already set
+    size_t mark_received(const size_t begin, const size_t end);
+
+    //! Clear the run of set bits that starts at `_expect`
+    //! \returns the length of the run
+    size_t take_received_run();
+
     void assemble();
 
+    //! Find the first stream index at or after `index` whose bit in `_received` equals `set`
+    //! \returns that index, or the end of the window if there is none
+    size_t find_bit(size_t index, const bool set) const;
+
   public:
     //! \brief Construct a `StreamReassembler` that will store up to `capacity` bytes.
     //! \note This capacity limits both the bytes that have been reassembled,
@@ -38,7 +53,7 @@ class StreamReassembler {
     //! \param data the substring
     //! \param index indicates the index (place in sequence) of the first byte in `data`
     //! \param eof the last byte of `data` will be the last byte in the entire stream
-    void push_substring(const std::string &data, const uint64_t index, const bool eof);
+    void push_substring(std::string_view data, const uint64_t index, const bool eof);
 
     //! \name Access the reassembled byte stream
     //!@{
@@ -52,6 +67,9 @@ class StreamReassembler {
     //! should only be counted once for the purpose of this function.
     size_t unassembled_bytes() const;
 
+    //! The stored but not yet reassembled bytes, as [begin, end) ranges of stream indices in order
+    std::vector<std::pair<uint64_t, uint64_t>> unassembled_ranges() const;
+
     //! \brief Is the internal state empty (other than the output stream)?
     //! \returns `true` if no substrings are waiting to be assembled
     bool empty() const;
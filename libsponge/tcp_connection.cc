@@ -3,8 +3,10 @@
 #include "tcp_header.hh"
 #include "wrapping_integers.hh"
 
+#include <algorithm>
 #include <functional>
 #include <iostream>
+#include <limits>
 
 // Dummy implementation of a TCP connection
 
@@ -16,12 +18,68 @@ void DUMMY_CODE(Targs &&... /* unused */) {}
 
 using namespace std;
 
+uint8_t TCPConnection::window_shift(const size_t capacity) {
+    uint8_t shift = 0;
+    while (shift < TCPHeader::MAX_WSCALE && (capacity >> shift) > numeric_limits<uint16_t>::max()) {
+        shift++;
+    }
+    return shift;
+}
+
 void TCPConnection::set_ack_everytime(TCPHeader &header) {
     header.ack = _receiver.ackno().has_value();
     if (header.ack) {
         header.ackno = _receiver.ackno().value();
     }
-    header.win = _receiver.window_size();
+    // the window in a SYN is never scaled
+    const uint8_t shift = _wscale_ok && !header.syn ? _rcv_wscale : 0;
+    header.win = min(_receiver.window_size() >> shift, size_t{numeric_limits<uint16_t>::max()});
+}
+
+//! \details Send our MSS and offer window scaling and SACK on our SYN (on a SYN-ACK, only the options the
+//! peer offered too), attach SACK blocks to ACKs once it's agreed, and make the data offset cover the options.
+void TCPConnection::set_options(TCPSegment &segment) {
+    TCPHeader &header = segment.header();
+    const bool peer_syn_seen = _receiver.ackno().has_value();
+    header.mss.reset();
+    header.wscale.reset();
+    if (header.syn) {
+        header.mss = min(_cfg.mss, size_t{numeric_limits<uint16_t>::max()});
+        if (_cfg.window_scale && (!peer_syn_seen || _wscale_ok)) {
+            header.wscale = _rcv_wscale;
+        }
+    }
+    header.sack_permitted = header.syn && _cfg.sack && (!peer_syn_seen || _sack_ok);
+    if (_sack_ok && header.ack) {
+        // options count against the MSS, so only send the blocks that fit next to the payload (RFC 6691)
+        const size_t payload = segment.payload().size();
+        const size_t room = _sender.segment_size() > payload + 4 ? _sender.segment_size() - payload - 4 : 0;
+        header.sack = _receiver.sack_blocks(min(room / 8, TCPHeader::MAX_SACK_BLOCKS));
+    }
+    header.doff = (TCPHeader::LENGTH + header.options_length()) / 4;
+}
+
+//! \details ACK at least every second full-sized segment and within `ack_delay` milliseconds, and ACK
+//! right away when a segment arrives out of order or fills a hole, so the peer's fast retransmit and
+//! recovery aren't held up ([RFC 5681](\ref rfc::rfc5681), section 4.2). SYNs and FINs are ACKed right away too.
+bool TCPConnection::delay_ack(const TCPSegment &seg, const bool in_order) {
+    const size_t payload = seg.payload().size();
+    if (!_cfg.delayed_ack || !in_order || payload == 0 || seg.header().syn || seg.header().fin) {
+        return false;
+    }
+    // a segment the window cut short or refused gets an immediate answer
+    if (_receiver.ackno().value() != seg.header().seqno + payload) {
+        return false;
+    }
+    _rcv_mss = max(_rcv_mss, payload);
+    _unacked_bytes += payload;
+    if (_unacked_bytes >= 2 * _rcv_mss) {
+        return false;
+    }
+    if (!_ack_due.has_value()) {
+        _ack_due = _now_time + _cfg.ack_delay;
+    }
+    return true;
 }
 
 void TCPConnection::check_is_fin(TCPHeader &header) { _is_fin |= header.fin; }
@@ -32,7 +90,13 @@ void TCPConnection::move_all_segments_to_out(std::function<void(TCPHeader &)> ed
         auto &segment = product_segments.front();
         check_is_fin(segment.header());
         set_ack_everytime(segment.header());
+        set_options(segment);
         edit_header(segment.header());
+        if (segment.header().ack) {
+            // a pending delayed ACK rides along
+            _ack_due.reset();
+            _unacked_bytes = 0;
+        }
         _segments_out.emplace(std::move(segment));
         product_segments.pop();
     }
@@ -56,8 +120,40 @@ size_t TCPConnection::unassembled_bytes() const { return _receiver.unassembled_b
 
 size_t TCPConnection::time_since_last_segment_received() const { return _now_time - _last_receive_time; }
 
+//! \details Van Jacobson's header prediction: on an established connection, almost every segment is either
+//! the next in-order data, acknowledging nothing new, or a pure ACK for new data. Neither needs the SYN,
+//! RST, SACK and window-scale handling of the general path, nor more than one pass over the sender.
+bool TCPConnection::segment_predicted(const TCPSegment &seg) {
+    const TCPHeader &header = seg.header();
+    if (!header.ack || header.syn || header.fin || header.rst || header.urg || !header.sack.empty() || _is_fin ||
+        !_receiver.ackno().has_value() || header.seqno != _receiver.ackno().value()) {
+        return false;
+    }
+
+    const uint32_t window = uint32_t{header.win} << (_wscale_ok ? _snd_wscale : 0);
+    if (seg.payload().size() == 0) {
+        if (!_sender.fast_ack(header.ackno, window)) {
+            return false;
+        }
+        _sender.fill_window();
+    } else {
+        if (!_sender.ack_unchanged(header.ackno, window) || !_receiver.segment_in_order(seg)) {
+            return false;
+        }
+        _linger_after_streams_finish = !_receiver.stream_out().input_ended();
+        if (!delay_ack(seg, true)) {
+            _sender.send_empty_segment();
+        }
+    }
+    move_all_segments_to_out();
+    return true;
+}
+
 void TCPConnection::segment_received(const TCPSegment &seg) {
     _last_receive_time = _now_time;
+    if (segment_predicted(seg)) {
+        return;
+    }
     if (seg.header().rst) {
         _receiver.stream_out().set_error();
         _sender.stream_in().set_error();
@@ -65,20 +161,42 @@ void TCPConnection::segment_received(const TCPSegment &seg) {
         return;
     }
 
+    if (seg.header().syn) {
+        if (!_receiver.ackno().has_value()) {
+            _sender.set_peer_mss(seg.header().mss.value_or(TCPConfig::DEFAULT_PEER_MSS));
+        }
+        _sack_ok = _cfg.sack && seg.header().sack_permitted;
+        if (_sack_ok) {
+            _sender.enable_sack();
+        }
+        _wscale_ok = _cfg.window_scale && seg.header().wscale.has_value();
+        if (_wscale_ok) {
+            _snd_wscale = min(seg.header().wscale.value(), TCPHeader::MAX_WSCALE);
+        }
+    }
+
+    const optional<WrappingInt32> ackno_before = _receiver.ackno();
+    const bool in_order = ackno_before.has_value() && seg.header().seqno == ackno_before.value() &&
+                          _receiver.unassembled_bytes() == 0;
     _receiver.segment_received(seg);
     if (!_is_fin) {
         _linger_after_streams_finish = !_receiver.stream_out().input_ended();
     }
 
     if (_receiver.ackno().has_value() && seg.header().ack) {
-        _sender.ack_received(seg.header().ackno, seg.header().win);
+        if (_sack_ok && !seg.header().sack.empty()) {
+            _sender.sack_received(seg.header().sack);
+        }
+        const uint8_t shift = _wscale_ok && !seg.header().syn ? _snd_wscale : 0;
+        const uint32_t window = uint32_t{seg.header().win} << shift;
+        _sender.ack_received(seg.header().ackno, window, seg.length_in_sequence_space() == 0);
         _sender.fill_window();
     }
 
     if (_receiver.ackno().has_value() &&
         (seg.length_in_sequence_space() != 0 || _receiver.ackno().value() - 1 == seg.header().seqno)) {
         _sender.fill_window();
-        if (_sender.segments_out().empty()) {
+        if (_sender.segments_out().empty() && !delay_ack(seg, in_order)) {
             _sender.send_empty_segment();
         }
     }
@@ -95,6 +213,13 @@ size_t TCPConnection::write(const string &data) {
     return ret;
 }
 
+size_t TCPConnection::write(string &&data) {
+    size_t ret = _sender.stream_in().write(move(data));
+    _sender.fill_window();
+    move_all_segments_to_out();
+    return ret;
+}
+
 //! \param[in] ms_since_last_tick number of milliseconds since the last call to this method
 void TCPConnection::tick(const size_t ms_since_last_tick) {
     _now_time += ms_since_last_tick;
@@ -105,6 +230,9 @@ void TCPConnection::tick(const size_t ms_since_last_tick) {
         _receiver.stream_out().set_error();
         _sender.stream_in().set_error();
     } else {
+        if (_ack_due.has_value() && _now_time >= _ack_due.value() && _sender.segments_out().empty()) {
+            _sender.send_empty_segment();
+        }
         move_all_segments_to_out();
     }
 }
@@ -115,6 +243,25 @@ void TCPConnection::end_input_stream() {
     move_all_segments_to_out();
 }
 
+void TCPConnection::cork() { _sender.set_cork(true); }
+
+void TCPConnection::uncork() {
+    _sender.set_cork(false);
+    // before connect(), filling the window would send a SYN
+    if (_sender.next_seqno_absolute() > 0) {
+        _sender.fill_window();
+        move_all_segments_to_out();
+    }
+}
+
+void TCPConnection::set_nodelay(const bool nodelay) {
+    _sender.set_nagle(!nodelay);
+    if (_sender.next_seqno_absolute() > 0) {
+        _sender.fill_window();
+        move_all_segments_to_out();
+    }
+}
+
 void TCPConnection::connect() {
     _sender.fill_window();
     move_all_segments_to_out();
@@ -9,13 +9,14 @@
 
 #include <cstddef>
 #include <functional>
+#include <optional>
 
 //! \brief A complete endpoint of a TCP connection
 class TCPConnection {
   private:
     TCPConfig _cfg;
     TCPReceiver _receiver{_cfg.recv_capacity};
-    TCPSender _sender{_cfg.send_capacity, _cfg.rt_timeout, _cfg.fixed_isn};
+    TCPSender _sender{_cfg};
 
     //! outbound queue of segments that the TCPConnection wants sent
     std::queue<TCPSegment> _segments_out{};
@@ -28,8 +29,32 @@ class TCPConnection {
     bool _is_fin{false};
     size_t _now_time{0};
     size_t _last_receive_time{0};
+    bool _sack_ok{false};  //!< both sides offered SACK in their SYNs
 
+    //! \name Window scaling ([RFC 7323](\ref rfc::rfc7323)), in effect once both SYNs carried the option
+    //!@{
+    bool _wscale_ok{false};
+    uint8_t _rcv_wscale{window_shift(_cfg.recv_capacity)};  //!< shift applied to the windows we advertise
+    uint8_t _snd_wscale{0};                                 //!< shift applied to the windows the peer advertises
+    //!@}
+
+    //! \name Delayed ACKs ([RFC 1122](\ref rfc::rfc1122), section 4.2.3.2)
+    //!@{
+    std::optional<size_t> _ack_due{};  //!< time by which the pending ACK has to go out, if one is pending
+    size_t _unacked_bytes{0};          //!< payload received since we last sent an ACK
+    size_t _rcv_mss{0};                //!< largest payload received so far, taken as the peer's full segment size
+    //!@}
+
+    //! Header prediction: handle the common in-order segments quickly; `false` if `seg` needs the general path
+    bool segment_predicted(const TCPSegment &seg);
+
+    //! Whether the ACK for `seg` may wait; `in_order` says it arrived at the ackno with nothing queued beyond
+    bool delay_ack(const TCPSegment &seg, const bool in_order);
     void set_ack_everytime(TCPHeader &);
+
+    //! Smallest shift that lets a window of `capacity` bytes fit in the 16-bit window field
+    static uint8_t window_shift(const size_t capacity);
+    void set_options(TCPSegment &);
     void check_is_fin(TCPHeader &);
     void move_all_segments_to_out(std::function<void(TCPHeader &)> edit_header = [](TCPHeader &) {});
     bool check_is_active() const;
@@ -45,11 +70,24 @@ class TCPConnection {
     //! \returns the number of bytes from `data` that were actually written.
     size_t write(const std::string &data);
 
+    //! \brief Write data to the outbound byte stream, handing over ownership of `data` to avoid a copy
+    //! \returns the number of bytes from `data` that were actually written.
+    size_t write(std::string &&data);
+
     //! \returns the number of `bytes` that can be written right now.
     size_t remaining_outbound_capacity() const;
 
     //! \brief Shut down the outbound byte stream (still allows reading incoming data)
     void end_input_stream();
+
+    //! \brief Hold back partial segments until uncork() or the end of the stream, to coalesce small writes
+    void cork();
+
+    //! \brief Send what cork() held back
+    void uncork();
+
+    //! \brief Turn Nagle's algorithm off (`true`) for latency-sensitive flows, or back on (`false`)
+    void set_nodelay(const bool nodelay);
     //!@}
 
     //! \name "Output" interface for the reader
@@ -1,6 +1,7 @@
 #include "arp_message.hh"
 
 #include <arpa/inet.h>
+#include <cstring>
 #include <iomanip>
 #include <sstream>
 
@@ -9,31 +10,28 @@ using namespace std;
 ParseResult ARPMessage::parse(const Buffer buffer) {
     NetParser p{buffer};
 
-    if (p.buffer().size() < ARPMessage::LENGTH) {
+    const char *m = p.take(ARPMessage::LENGTH);
+    if (m == nullptr) {
         return ParseResult::PacketTooShort;
     }
 
-    hardware_type = p.u16();
-    protocol_type = p.u16();
-    hardware_address_size = p.u8();
-    protocol_address_size = p.u8();
-    opcode = p.u16();
+    hardware_type = NetParser::load_u16(m);
+    protocol_type = NetParser::load_u16(m + 2);
+    hardware_address_size = NetParser::load_u8(m + 4);
+    protocol_address_size = NetParser::load_u8(m + 5);
+    opcode = NetParser::load_u16(m + 6);
 
     if (not supported()) {
         return ParseResult::Unsupported;
     }
 
     // read sender addresses (Ethernet and IP)
-    for (auto &byte : sender_ethernet_address) {
-        byte = p.u8();
-    }
-    sender_ip_address = p.u32();
+    memcpy(sender_ethernet_address.data(), m + 8, sender_ethernet_address.size());
+    sender_ip_address = NetParser::load_u32(m + 14);
 
     // read target addresses (Ethernet and IP)
-    for (auto &byte : target_ethernet_address) {
-        byte = p.u8();
-    }
-    target_ip_address = p.u32();
+    memcpy(target_ethernet_address.data(), m + 18, target_ethernet_address.size());
+    target_ip_address = NetParser::load_u32(m + 24);
 
     return p.get_error();
 }
@@ -45,31 +43,30 @@ bool ARPMessage::supported() const {
 }
 
 string ARPMessage::serialize() const {
+    string ret(LENGTH, 0);
+    serialize(ret.data());
+    return ret;
+}
+
+void ARPMessage::serialize(char *dest) const {
     if (not supported()) {
         throw runtime_error(
             "ARPMessage::serialize(): unsupported field combination (must be Ethernet/IP, and request or reply)");
     }
 
-    string ret;
-    NetUnparser::u16(ret, hardware_type);
-    NetUnparser::u16(ret, protocol_type);
-    NetUnparser::u8(ret, hardware_address_size);
-    NetUnparser::u8(ret, protocol_address_size);
-    NetUnparser::u16(ret, opcode);
+    NetUnparser::store_u16(dest, hardware_type);
+    NetUnparser::store_u16(dest + 2, protocol_type);
+    NetUnparser::store_u8(dest + 4, hardware_address_size);
+    NetUnparser::store_u8(dest + 5, protocol_address_size);
+    NetUnparser::store_u16(dest + 6, opcode);
 
     /* write sender addresses */
-    for (auto &byte : sender_ethernet_address) {
-        NetUnparser::u8(ret, byte);
-    }
-    NetUnparser::u32(ret, sender_ip_address);
+    memcpy(dest + 8, sender_ethernet_address.data(), sender_ethernet_address.size());
+    NetUnparser::store_u32(dest + 14, sender_ip_address);
 
     /* write target addresses */
-    for (auto &byte : target_ethernet_address) {
-        NetUnparser::u8(ret, byte);
-    }
-    NetUnparser::u32(ret, target_ip_address);
-
-    return ret;
+    memcpy(dest + 18, target_ethernet_address.data(), target_ethernet_address.size());
+    NetUnparser::store_u32(dest + 24, target_ip_address);
 }
 
 string ARPMessage::to_string() const {
@@ -34,6 +34,9 @@ struct ARPMessage {
     //! Serialize the ARP message to a string
     std::string serialize() const;
 
+    //! Serialize the ARP message into the `LENGTH` bytes at `dest`
+    void serialize(char *dest) const;
+
     //! Return a string containing the ARP message in human-readable format
     std::string to_string() const;
 
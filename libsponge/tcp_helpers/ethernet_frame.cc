@@ -17,8 +17,20 @@ ParseResult EthernetFrame::parse(const Buffer buffer) {
 }
 
 BufferList EthernetFrame::serialize() const {
-    BufferList ret;
-    ret.append(_header.serialize());
-    ret.append(_payload);
+    // the header goes in place in front of a payload whose first Buffer left room for it (e.g. a serialized
+    // IPv4Datagram), or else into a Buffer of its own
+    const size_t header_len = EthernetHeader::LENGTH;
+    const bool in_place = not _payload.buffers().empty() and _payload.buffers().front().headroom() >= header_len;
+    Buffer packet = in_place ? _payload.buffers().front() : Buffer::allocate(header_len);
+    _header.serialize(packet.prepend(header_len));
+
+    BufferList ret{packet};
+    if (in_place) {
+        BufferList rest = _payload;
+        rest.remove_prefix(_payload.buffers().front().size());
+        ret.append(rest);
+    } else {
+        ret.append(_payload);
+    }
     return ret;
 }
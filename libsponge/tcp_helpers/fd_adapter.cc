@@ -50,7 +50,7 @@ optional<TCPSegment> TCPOverUDPSocketAdapter::read() {
 void TCPOverUDPSocketAdapter::write(TCPSegment &seg) {
     seg.header().sport = config().source.port();
     seg.header().dport = config().destination.port();
-    _sock.sendto(config().destination, seg.serialize(0));
+    _sock.send_packet(config().destination, seg.serialize(0));
 }
 
 //! Specialize LossyFdAdapter to TCPOverUDPSocketAdapter
@@ -2,12 +2,14 @@
 #define SPONGE_LIBSPONGE_FD_ADAPTER_HH
 
 #include "file_descriptor.hh"
+#include "ipv4_header.hh"
 #include "lossy_fd_adapter.hh"
 #include "socket.hh"
 #include "tcp_config.hh"
 #include "tcp_header.hh"
 #include "tcp_segment.hh"
 
+#include <cstddef>
 #include <optional>
 #include <utility>
 
@@ -40,6 +42,9 @@ class FdAdapterBase {
 
     //! Called periodically when time elapses
     void tick(const size_t) {}
+
+    //! Largest TCP payload that fits in one datagram on the link, or 0 if the adapter doesn't know
+    size_t mss() const { return 0; }
 };
 
 //! \brief A FD adaptor that reads and writes TCP segments in UDP payloads
@@ -57,6 +62,12 @@ class TCPOverUDPSocketAdapter : public FdAdapterBase {
     //! Writes a TCP segment into a UDP payload
     void write(TCPSegment &seg);
 
+    //! IPv4, UDP and TCP headers in front of each payload
+    static constexpr size_t HEADERS_LENGTH = IPv4Header::LENGTH + 8 + TCPHeader::LENGTH;
+
+    //! Largest TCP payload that fits in one datagram on a path with the configured MTU, or 0 if that's unknown
+    size_t mss() const { return config().mtu > HEADERS_LENGTH ? config().mtu - HEADERS_LENGTH : 0; }
+
     //! Access the underlying UDP socket
     operator UDPSocket &() { return _sock; }
 
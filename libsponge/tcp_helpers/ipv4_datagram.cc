@@ -11,7 +11,8 @@ using namespace std;
 ParseResult IPv4Datagram::parse(const Buffer buffer) {
     NetParser p{buffer};
     _header.parse(p);
-    _payload = p.buffer();
+    // whatever follows the datagram (e.g. padding up to Ethernet's minimum frame size) is sliced off
+    _payload = p.buffer().substr(0, _header.payload_length());
 
     if (_payload.size() != _header.payload_length()) {
         return ParseResult::PacketTooShort;
@@ -25,17 +26,29 @@ BufferList IPv4Datagram::serialize() const {
         throw runtime_error("IPv4Datagram::serialize: payload is wrong size");
     }
 
-    IPv4Header header_out = _header;
-    header_out.cksum = 0;
-    const string header_zero_checksum = header_out.serialize();
+    // the header goes in place in front of a payload whose first Buffer left room for it (e.g. a serialized
+    // TCPSegment), or else into a Buffer of its own
+    const size_t header_len = 4 * _header.hlen;
+    const bool in_place = not _payload.buffers().empty() and _payload.buffers().front().headroom() >= header_len;
+    Buffer packet = in_place ? _payload.buffers().front() : Buffer::allocate(header_len);
+    char *const header = packet.prepend(header_len);
+
+    // the header is serialized with a zero checksum; the checksum is then written into it
+    _header.serialize(header);
+    NetUnparser::store_u16(header + IPv4Header::CKSUM_OFFSET, 0);
 
     // calculate checksum -- taken over header only
     InternetChecksum check;
-    check.add(header_zero_checksum);
-    header_out.cksum = check.value();
-
-    BufferList ret;
-    ret.append(header_out.serialize());
-    ret.append(_payload);
+    check.add({header, header_len});
+    NetUnparser::store_u16(header + IPv4Header::CKSUM_OFFSET, check.value());
+
+    BufferList ret{packet};
+    if (in_place) {
+        BufferList rest = _payload;
+        rest.remove_prefix(_payload.buffers().front().size());
+        ret.append(rest);
+    } else {
+        ret.append(_payload);
+    }
     return ret;
 }
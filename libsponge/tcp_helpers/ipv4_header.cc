@@ -2,6 +2,7 @@
 
 #include "util.hh"
 
+#include <algorithm>
 #include <arpa/inet.h>
 #include <iomanip>
 #include <sstream>
@@ -21,30 +22,29 @@ using namespace std;
 //! - there is less data in the full datagram than the `len` field claims
 //! - the checksum is bad
 ParseResult IPv4Header::parse(NetParser &p) {
-    Buffer original_serialized_version = p.buffer();
-
-    const size_t data_size = p.buffer().size();
+    const size_t data_size = p.size();
     if (data_size < IPv4Header::LENGTH) {
         return ParseResult::PacketTooShort;
     }
 
-    const uint8_t first_byte = p.u8();
-    ver = first_byte >> 4;     // version
-    hlen = first_byte & 0x0f;  // header length
-    tos = p.u8();              // type of service
-    len = p.u16();             // length
-    id = p.u16();              // id
+    const char *h = p.take(IPv4Header::LENGTH);
+    const uint8_t first_byte = NetParser::load_u8(h);
+    ver = first_byte >> 4;             // version
+    hlen = first_byte & 0x0f;          // header length
+    tos = NetParser::load_u8(h + 1);   // type of service
+    len = NetParser::load_u16(h + 2);  // length
+    id = NetParser::load_u16(h + 4);   // id
 
-    const uint16_t fo_val = p.u16();
+    const uint16_t fo_val = NetParser::load_u16(h + 6);
     df = static_cast<bool>(fo_val & 0x4000);  // don't fragment
     mf = static_cast<bool>(fo_val & 0x2000);  // more fragments
     offset = fo_val & 0x1fff;                 // offset
 
-    ttl = p.u8();     // ttl
-    proto = p.u8();   // proto
-    cksum = p.u16();  // checksum
-    src = p.u32();    // source address
-    dst = p.u32();    // destination address
+    ttl = NetParser::load_u8(h + 8);      // ttl
+    proto = NetParser::load_u8(h + 9);    // proto
+    cksum = NetParser::load_u16(h + 10);  // checksum
+    src = NetParser::load_u32(h + 12);    // source address
+    dst = NetParser::load_u32(h + 16);    // destination address
 
     if (data_size < 4 * hlen) {
         return ParseResult::PacketTooShort;
@@ -55,7 +55,7 @@ ParseResult IPv4Header::parse(NetParser &p) {
     if (hlen < 5) {
         return ParseResult::HeaderTooShort;
     }
-    if (data_size != len) {
+    if (data_size < len) {
         return ParseResult::TruncatedPacket;
     }
 
@@ -65,8 +65,9 @@ ParseResult IPv4Header::parse(NetParser &p) {
         return p.get_error();
     }
 
+    // the options follow the fixed header in the same contiguous bytes
     InternetChecksum check;
-    check.add({original_serialized_version.str().data(), size_t(4 * hlen)});
+    check.add({h, size_t(4 * hlen)});
     if (check.value()) {
         return ParseResult::BadChecksum;
     }
@@ -76,6 +77,13 @@ ParseResult IPv4Header::parse(NetParser &p) {
 
 //! Serialize the IPv4Header to a string (does not recompute the checksum)
 string IPv4Header::serialize() const {
+    string ret(4 * hlen, 0);
+    serialize(ret.data());
+    return ret;
+}
+
+//! \param[out] dest receives the header (without recomputing the checksum), padded to the advertised size
+void IPv4Header::serialize(char *dest) const {
     // sanity checks
     if (ver != 4) {
         throw runtime_error("wrong IP version");
@@ -84,29 +92,24 @@ string IPv4Header::serialize() const {
         throw runtime_error("IP header too short");
     }
 
-    string ret;
-    ret.reserve(4 * hlen);
-
     const uint8_t first_byte = (ver << 4) | (hlen & 0xf);
-    NetUnparser::u8(ret, first_byte);  // version and header length
-    NetUnparser::u8(ret, tos);         // type of service
-    NetUnparser::u16(ret, len);        // length
-    NetUnparser::u16(ret, id);         // id
+    NetUnparser::store_u8(dest, first_byte);  // version and header length
+    NetUnparser::store_u8(dest + 1, tos);     // type of service
+    NetUnparser::store_u16(dest + 2, len);    // length
+    NetUnparser::store_u16(dest + 4, id);     // id
 
     const uint16_t fo_val = (df ? 0x4000 : 0) | (mf ? 0x2000 : 0) | (offset & 0x1fff);
-    NetUnparser::u16(ret, fo_val);  // flags and offset
-
-    NetUnparser::u8(ret, ttl);    // time to live
-    NetUnparser::u8(ret, proto);  // protocol number
+    NetUnparser::store_u16(dest + 6, fo_val);  // flags and offset
 
-    NetUnparser::u16(ret, cksum);  // checksum
+    NetUnparser::store_u8(dest + 8, ttl);    // time to live
+    NetUnparser::store_u8(dest + 9, proto);  // protocol number
 
-    NetUnparser::u32(ret, src);  // src address
-    NetUnparser::u32(ret, dst);  // dst address
+    NetUnparser::store_u16(dest + 10, cksum);  // checksum
 
-    ret.resize(4 * hlen);  // expand header to advertised size
+    NetUnparser::store_u32(dest + 12, src);  // src address
+    NetUnparser::store_u32(dest + 16, dst);  // dst address
 
-    return ret;
+    fill(dest + IPv4Header::LENGTH, dest + 4 * hlen, 0);  // expand header to advertised size
 }
 
 uint16_t IPv4Header::payload_length() const { return len - 4 * hlen; }
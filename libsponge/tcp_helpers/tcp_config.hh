@@ -15,11 +15,40 @@ class TCPConfig {
     static constexpr size_t MAX_PAYLOAD_SIZE = 1000;   //!< Conservative max payload size for real Internet
     static constexpr uint16_t TIMEOUT_DFLT = 1000;     //!< Default re-transmit timeout is 1 second
     static constexpr unsigned MAX_RETX_ATTEMPTS = 8;   //!< Maximum re-transmit attempts before giving up
+    static constexpr uint16_t MIN_RTO_DFLT = 200;      //!< Default lower bound on an adaptive re-transmit timeout
+    static constexpr size_t DEFAULT_PEER_MSS = 536;    //!< Send MSS when the peer's SYN has no MSS option (IPv4)
+    static constexpr uint16_t ACK_DELAY_DFLT = 40;     //!< Default bound on how long an ACK may be delayed
+
+    //! Congestion-control algorithm used by the sender
+    enum class CongestionControl {
+        None,     //!< No congestion window: send whatever the peer's window allows
+        NewReno,  //!< Slow start and AIMD congestion avoidance ([RFC 5681](\ref rfc::rfc5681))
+        Cubic,    //!< CUBIC window growth ([RFC 9438](\ref rfc::rfc9438))
+    };
 
     uint16_t rt_timeout = TIMEOUT_DFLT;       //!< Initial value of the retransmission timeout, in milliseconds
     size_t recv_capacity = DEFAULT_CAPACITY;  //!< Receive capacity, in bytes
     size_t send_capacity = DEFAULT_CAPACITY;  //!< Sender capacity, in bytes
     std::optional<WrappingInt32> fixed_isn{};
+    bool adaptive_rto = false;        //!< Derive the retransmission timeout from measured RTTs (RFC 6298)
+    uint16_t min_rto = MIN_RTO_DFLT;  //!< Lower bound on the adaptive retransmission timeout, in milliseconds
+
+    //! Sender's congestion-control algorithm
+    CongestionControl congestion_control = CongestionControl::None;
+    bool sack = false;         //!< Offer and use selective acknowledgments ([RFC 2018](\ref rfc::rfc2018))
+    bool window_scale = true;  //!< Offer window scaling ([RFC 7323](\ref rfc::rfc7323)) for windows over 64 KiB
+
+    //! Largest payload we accept (sent in the MSS option) and send; TCPSpongeSocket derives it from the link MTU
+    size_t mss = MAX_PAYLOAD_SIZE;
+    //! Start from segments of MAX_PAYLOAD_SIZE and probe up to `mss` ([RFC 4821](\ref rfc::rfc4821))
+    bool pmtu_discovery = false;
+
+    //! Hold back a short segment while data is unacknowledged ([RFC 896](\ref rfc::rfc896), Nagle's algorithm)
+    bool nagle = false;
+
+    //! ACK every second full-sized segment instead of every segment ([RFC 1122](\ref rfc::rfc1122), 4.2.3.2)
+    bool delayed_ack = false;
+    uint16_t ack_delay = ACK_DELAY_DFLT;  //!< Longest a delayed ACK waits, in milliseconds
 };
 
 //! Config for classes derived from FdAdapter
@@ -30,6 +59,8 @@ class FdAdapterConfig {
 
     uint16_t loss_rate_dn = 0;  //!< Downlink loss rate (for LossyFdAdapter)
     uint16_t loss_rate_up = 0;  //!< Uplink loss rate (for LossyFdAdapter)
+
+    uint16_t mtu = 0;  //!< MTU of the UDP path (for TCPOverUDPSocketAdapter), or 0 if unknown
 };
 
 #endif  // SPONGE_LIBSPONGE_TCP_CONFIG_HH
@@ -1,9 +1,59 @@
 #include "tcp_header.hh"
 
+#include <algorithm>
 #include <sstream>
+#include <stdexcept>
+#include <string_view>
 
 using namespace std;
 
+//! \param[out] header receives the options
+//! \param[in] options is the options area (the header's bytes beyond TCPHeader::LENGTH)
+//! \details Unknown options are skipped. An option whose length is impossible ends parsing,
+//! and the rest of the options area is skipped.
+static void parse_options(TCPHeader &header, string_view options) {
+    header.mss.reset();
+    header.wscale.reset();
+    header.sack_permitted = false;
+    header.sack.clear();
+
+    while (not options.empty()) {
+        const uint8_t kind = NetParser::load_u8(options.data());
+        options.remove_prefix(1);
+        if (kind == TCPHeader::OPT_EOL) {
+            break;
+        }
+        if (kind == TCPHeader::OPT_NOP) {
+            continue;
+        }
+
+        // every other option is kind, length (counting both of these bytes), value
+        if (options.empty()) {
+            break;
+        }
+        const uint8_t opt_len = NetParser::load_u8(options.data());
+        options.remove_prefix(1);
+        if (opt_len < 2 or opt_len - 2u > options.size()) {
+            break;
+        }
+        const string_view value = options.substr(0, opt_len - 2);
+        options.remove_prefix(value.size());
+
+        if (kind == TCPHeader::OPT_MSS and value.size() == 2) {
+            header.mss = NetParser::load_u16(value.data());
+        } else if (kind == TCPHeader::OPT_WSCALE and value.size() == 1) {
+            header.wscale = NetParser::load_u8(value.data());
+        } else if (kind == TCPHeader::OPT_SACK_PERMITTED and value.empty()) {
+            header.sack_permitted = true;
+        } else if (kind == TCPHeader::OPT_SACK and value.size() % 8 == 0) {
+            for (size_t i = 0; i < value.size(); i += 8) {
+                header.sack.push_back({WrappingInt32{NetParser::load_u32(value.data() + i)},
+                                       WrappingInt32{NetParser::load_u32(value.data() + i + 4)}});
+            }
+        }
+    }
+}
+
 //! \param[in,out] p is a NetParser from which the TCP fields will be extracted
 //! \returns a ParseResult indicating success or the reason for failure
 //! \details It is important to check for (at least) the following potential errors
@@ -15,66 +65,144 @@ using namespace std;
 //! - there is less data in the header than the `doff` field claims
 //! - the checksum is bad
 ParseResult TCPHeader::parse(NetParser &p) {
-    sport = p.u16();                 // source port
-    dport = p.u16();                 // destination port
-    seqno = WrappingInt32{p.u32()};  // sequence number
-    ackno = WrappingInt32{p.u32()};  // ack number
-    doff = p.u8() >> 4;              // data offset
-
-    const uint8_t fl_b = p.u8();                  // byte including flags
-    urg = static_cast<bool>(fl_b & 0b0010'0000);  // binary literals and ' digit separator since C++14!!!
+    const char *h = p.take(TCPHeader::LENGTH);
+    if (h == nullptr) {
+        return p.get_error();
+    }
+
+    sport = NetParser::load_u16(h);                     // source port
+    dport = NetParser::load_u16(h + 2);                 // destination port
+    seqno = WrappingInt32{NetParser::load_u32(h + 4)};  // sequence number
+    ackno = WrappingInt32{NetParser::load_u32(h + 8)};  // ack number
+    doff = NetParser::load_u8(h + 12) >> 4;             // data offset
+
+    const uint8_t fl_b = NetParser::load_u8(h + 13);  // byte including flags
+    urg = static_cast<bool>(fl_b & 0b0010'0000);      // binary literals and ' digit separator since C++14!!!
     ack = static_cast<bool>(fl_b & 0b0001'0000);
     psh = static_cast<bool>(fl_b & 0b0000'1000);
     rst = static_cast<bool>(fl_b & 0b0000'0100);
     syn = static_cast<bool>(fl_b & 0b0000'0010);
     fin = static_cast<bool>(fl_b & 0b0000'0001);
 
-    win = p.u16();    // window size
-    cksum = p.u16();  // checksum
-    uptr = p.u16();   // urgent pointer
+    win = NetParser::load_u16(h + 14);    // window size
+    cksum = NetParser::load_u16(h + 16);  // checksum
+    uptr = NetParser::load_u16(h + 18);   // urgent pointer
 
     if (doff < 5) {
         return ParseResult::HeaderTooShort;
     }
 
-    // skip any options or anything extra in the header
-    p.remove_prefix(doff * 4 - TCPHeader::LENGTH);
-
-    if (p.error()) {
+    const size_t options_len = doff * 4 - TCPHeader::LENGTH;
+    const char *options = p.take(options_len);
+    if (options == nullptr) {
         return p.get_error();
     }
+    parse_options(*this, {options, options_len});
 
     return ParseResult::NoError;
 }
 
+size_t TCPHeader::options_length() const {
+    return (mss.has_value() ? 4 : 0) + (wscale.has_value() ? 4 : 0) + (sack_permitted ? 4 : 0) +
+           (sack.empty() ? 0 : 4 + 8 * sack.size());
+}
+
+//! \returns the header's options_length(), after checking that the options can be serialized
+static size_t checked_options_length(const TCPHeader &header) {
+    if (header.sack.size() > TCPHeader::MAX_SACK_BLOCKS) {
+        throw runtime_error("too many SACK blocks");
+    }
+    const size_t ret = header.options_length();
+    if (ret > TCPHeader::MAX_OPTIONS_LENGTH) {
+        throw runtime_error("TCP options too long");
+    }
+    return ret;
+}
+
+//! \param[in] header whose options to write, already checked by checked_options_length()
+//! \param[out] dest receives the header's options_length() bytes of options
+//! \details Options are written in kind order, each aligned the way common
+//! implementations do it, so the list needs no padding.
+static void write_options(const TCPHeader &header, char *dest) {
+    if (header.mss.has_value()) {
+        NetUnparser::store_u8(dest, TCPHeader::OPT_MSS);
+        NetUnparser::store_u8(dest + 1, 4);
+        NetUnparser::store_u16(dest + 2, header.mss.value());
+        dest += 4;
+    }
+
+    if (header.wscale.has_value()) {
+        NetUnparser::store_u8(dest, TCPHeader::OPT_NOP);
+        NetUnparser::store_u8(dest + 1, TCPHeader::OPT_WSCALE);
+        NetUnparser::store_u8(dest + 2, 3);
+        NetUnparser::store_u8(dest + 3, header.wscale.value());
+        dest += 4;
+    }
+
+    if (header.sack_permitted) {
+        NetUnparser::store_u8(dest, TCPHeader::OPT_NOP);
+        NetUnparser::store_u8(dest + 1, TCPHeader::OPT_NOP);
+        NetUnparser::store_u8(dest + 2, TCPHeader::OPT_SACK_PERMITTED);
+        NetUnparser::store_u8(dest + 3, 2);
+        dest += 4;
+    }
+
+    if (not header.sack.empty()) {
+        NetUnparser::store_u8(dest, TCPHeader::OPT_NOP);
+        NetUnparser::store_u8(dest + 1, TCPHeader::OPT_NOP);
+        NetUnparser::store_u8(dest + 2, TCPHeader::OPT_SACK);
+        NetUnparser::store_u8(dest + 3, 2 + 8 * header.sack.size());
+        dest += 4;
+        for (const auto &block : header.sack) {
+            NetUnparser::store_u32(dest, block.begin.raw_value());
+            NetUnparser::store_u32(dest + 4, block.end.raw_value());
+            dest += 8;
+        }
+    }
+}
+
+string TCPHeader::serialize_options() const {
+    string ret(checked_options_length(*this), 0);
+    write_options(*this, ret.data());
+    return ret;
+}
+
 //! Serialize the TCPHeader to a string (does not recompute the checksum)
 string TCPHeader::serialize() const {
+    string ret(4 * doff, 0);
+    serialize(ret.data());
+    return ret;
+}
+
+//! \param[out] dest receives the header (without recomputing the checksum), padded to the advertised size
+void TCPHeader::serialize(char *dest) const {
     // sanity check
     if (doff < 5) {
         throw runtime_error("TCP header too short");
     }
+    const size_t options_len = checked_options_length(*this);
+    if (LENGTH + options_len > 4 * doff) {
+        throw runtime_error("TCP options don't fit in the header");
+    }
 
-    string ret;
-    ret.reserve(4 * doff);
-
-    NetUnparser::u16(ret, sport);              // source port
-    NetUnparser::u16(ret, dport);              // destination port
-    NetUnparser::u32(ret, seqno.raw_value());  // sequence number
-    NetUnparser::u32(ret, ackno.raw_value());  // ack number
-    NetUnparser::u8(ret, doff << 4);           // data offset
+    NetUnparser::store_u16(dest, sport);                  // source port
+    NetUnparser::store_u16(dest + 2, dport);              // destination port
+    NetUnparser::store_u32(dest + 4, seqno.raw_value());  // sequence number
+    NetUnparser::store_u32(dest + 8, ackno.raw_value());  // ack number
+    NetUnparser::store_u8(dest + 12, doff << 4);          // data offset
 
     const uint8_t fl_b = (urg ? 0b0010'0000 : 0) | (ack ? 0b0001'0000 : 0) | (psh ? 0b0000'1000 : 0) |
                          (rst ? 0b0000'0100 : 0) | (syn ? 0b0000'0010 : 0) | (fin ? 0b0000'0001 : 0);
-    NetUnparser::u8(ret, fl_b);  // flags
-    NetUnparser::u16(ret, win);  // window size
-
-    NetUnparser::u16(ret, cksum);  // checksum
+    NetUnparser::store_u8(dest + 13, fl_b);  // flags
+    NetUnparser::store_u16(dest + 14, win);  // window size
 
-    NetUnparser::u16(ret, uptr);  // urgent pointer
+    NetUnparser::store_u16(dest + 16, cksum);  // checksum
 
-    ret.resize(4 * doff);  // expand header to advertised size
+    NetUnparser::store_u16(dest + 18, uptr);  // urgent pointer
 
-    return ret;
+    // the options, then zeros (EOL) out to the advertised size
+    write_options(*this, dest + LENGTH);
+    fill(dest + LENGTH + options_len, dest + 4 * doff, TCPHeader::OPT_EOL);
 }
 
 //! \returns A string with the header's contents
@@ -90,13 +218,38 @@ string TCPHeader::to_string() const {
        << "TCP winsize: " << +win << '\n'
        << "TCP cksum: " << +cksum << '\n'
        << "TCP uptr: " << +uptr << '\n';
+    if (mss.has_value()) {
+        ss << "TCP option: MSS " << dec << mss.value() << hex << '\n';
+    }
+    if (wscale.has_value()) {
+        ss << "TCP option: window scale " << +wscale.value() << '\n';
+    }
+    if (sack_permitted) {
+        ss << "TCP option: SACK permitted\n";
+    }
+    for (const auto &block : sack) {
+        ss << "TCP option: SACK " << block.begin << "-" << block.end << '\n';
+    }
     return ss.str();
 }
 
 string TCPHeader::summary() const {
     stringstream ss{};
     ss << "Header(flags=" << (syn ? "S" : "") << (ack ? "A" : "") << (rst ? "R" : "") << (fin ? "F" : "")
-       << ",seqno=" << seqno << ",ack=" << ackno << ",win=" << win << ")";
+       << ",seqno=" << seqno << ",ack=" << ackno << ",win=" << win;
+    if (mss.has_value()) {
+        ss << ",mss=" << mss.value();
+    }
+    if (wscale.has_value()) {
+        ss << ",wscale=" << +wscale.value();
+    }
+    if (sack_permitted) {
+        ss << ",sackOK";
+    }
+    for (const auto &block : sack) {
+        ss << ",sack=" << block.begin << "-" << block.end;
+    }
+    ss << ")";
     return ss.str();
 }
 
@@ -104,5 +257,6 @@ bool TCPHeader::operator==(const TCPHeader &other) const {
     // TODO(aozdemir) more complete check (right now we omit cksum, src, dst
     return seqno == other.seqno && ackno == other.ackno && doff == other.doff && urg == other.urg && ack == other.ack &&
            psh == other.psh && rst == other.rst && syn == other.syn && fin == other.fin && win == other.win &&
-           uptr == other.uptr;
+           uptr == other.uptr && mss == other.mss && wscale == other.wscale &&
+           sack_permitted == other.sack_permitted && sack == other.sack;
 }
@@ -4,10 +4,37 @@
 #include "parser.hh"
 #include "wrapping_integers.hh"
 
+#include <optional>
+#include <string>
+#include <vector>
+
+//! \brief A range [begin, end) of sequence space that a receiver holds beyond its ackno
+//! (see [SACK](\ref rfc::rfc2018))
+struct SACKBlock {
+    WrappingInt32 begin;  //!< first sequence number in the block
+    WrappingInt32 end;    //!< sequence number just past the block
+
+    bool operator==(const SACKBlock &other) const { return begin == other.begin && end == other.end; }
+};
+
 //! \brief [TCP](\ref rfc::rfc793) segment header
-//! \note TCP options are not supported
+//! \note Options other than the ones below are skipped when parsing
 struct TCPHeader {
-    static constexpr size_t LENGTH = 20;  //!< [TCP](\ref rfc::rfc793) header length, not including options
+    static constexpr size_t LENGTH = 20;              //!< [TCP](\ref rfc::rfc793) header length, not including options
+    static constexpr size_t MAX_OPTIONS_LENGTH = 40;  //!< Room for options left by the 4-bit data offset
+    static constexpr size_t MAX_SACK_BLOCKS = 4;      //!< SACK blocks that fit in the options
+    static constexpr uint8_t MAX_WSCALE = 14;         //!< Largest window-scale shift ([RFC 7323](\ref rfc::rfc7323))
+    static constexpr size_t CKSUM_OFFSET = 16;        //!< Position of the checksum field in the header
+
+    //! \name Option kinds
+    //!@{
+    static constexpr uint8_t OPT_EOL = 0;             //!< end of option list
+    static constexpr uint8_t OPT_NOP = 1;             //!< no-operation (padding)
+    static constexpr uint8_t OPT_MSS = 2;             //!< maximum segment size
+    static constexpr uint8_t OPT_WSCALE = 3;          //!< [window scale](\ref rfc::rfc7323)
+    static constexpr uint8_t OPT_SACK_PERMITTED = 4;  //!< [SACK](\ref rfc::rfc2018)-permitted
+    static constexpr uint8_t OPT_SACK = 5;            //!< [SACK](\ref rfc::rfc2018) blocks
+    //!@}
 
     //! \struct TCPHeader
     //! ~~~{.txt}
@@ -50,12 +77,30 @@ struct TCPHeader {
     uint16_t uptr = 0;          //!< urgent pointer
     //!@}
 
+    //! \name TCP options
+    //! \note `doff` must leave room for them: see options_length()
+    //!@{
+    std::optional<uint16_t> mss{};    //!< largest payload the sender of the SYN can receive (only on a SYN)
+    std::optional<uint8_t> wscale{};  //!< shift for the sender's later window fields (only on a SYN)
+    bool sack_permitted = false;      //!< the sender can use SACK blocks (only on a SYN)
+    std::vector<SACKBlock> sack{};    //!< blocks of data the sender has received beyond the ackno
+    //!@}
+
     //! Parse the TCP fields from the provided NetParser
     ParseResult parse(NetParser &p);
 
+    //! Serialize the TCP options, padded to a multiple of four bytes
+    std::string serialize_options() const;
+
+    //! Number of bytes the options take up in the header (a multiple of four)
+    size_t options_length() const;
+
     //! Serialize the TCP fields
     std::string serialize() const;
 
+    //! Serialize the TCP fields into the `4 * doff` bytes at `dest`
+    void serialize(char *dest) const;
+
     //! Return a string containing a header in human-readable format
     std::string to_string() const;
 
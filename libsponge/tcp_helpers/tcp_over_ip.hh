@@ -4,13 +4,18 @@
 #include "buffer.hh"
 #include "fd_adapter.hh"
 #include "ipv4_datagram.hh"
+#include "ipv4_header.hh"
 #include "tcp_segment.hh"
 
+#include <cstddef>
 #include <optional>
 
 //! \brief A converter from TCP segments to serialized IPv4 datagrams
 class TCPOverIPv4Adapter : public FdAdapterBase {
   public:
+    //! IPv4 and TCP headers in front of each payload
+    static constexpr size_t HEADERS_LENGTH = IPv4Header::LENGTH + TCPHeader::LENGTH;
+
     std::optional<TCPSegment> unwrap_tcp_in_ip(const InternetDatagram &ip_dgram);
 
     InternetDatagram wrap_tcp_in_ip(TCPSegment &seg);
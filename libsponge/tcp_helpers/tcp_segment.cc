@@ -26,20 +26,49 @@ size_t TCPSegment::length_in_sequence_space() const {
     return payload().str().size() + (header().syn ? 1 : 0) + (header().fin ? 1 : 0);
 }
 
+//! \param[in] payload the new payload
+//! \param[in] payload_sum the checksum of exactly the bytes of `payload`, starting from zero
+void TCPSegment::set_payload(Buffer payload, const InternetChecksum &payload_sum) {
+    _payload = move(payload);
+    _payload_sum.emplace(_payload, payload_sum);
+}
+
 //! \param[in] datagram_layer_checksum pseudo-checksum from the lower-layer protocol
+//! \details The header is written into a pooled Buffer with (at least) TCPSegment::HEADROOM bytes in front
+//! of it, so that the layers below can prepend their headers without another allocation. A payload of up to
+//! TCPSegment::MAX_COPIED_PAYLOAD bytes is copied in behind the header, in the same pass as the checksum
+//! unless that was computed already; a larger one follows as a Buffer of its own, sharing its storage.
 BufferList TCPSegment::serialize(const uint32_t datagram_layer_checksum) const {
-    TCPHeader header_out = _header;
-    header_out.cksum = 0;
+    const size_t header_len = 4 * _header.doff;
+    const bool copied = _payload.size() <= MAX_COPIED_PAYLOAD;
+    Buffer packet = Buffer::allocate(HEADROOM + header_len + (copied ? _payload.size() : 0));
+    char *const payload = copied ? packet.prepend(_payload.size()) : nullptr;
+    char *const header = packet.prepend(header_len);
+
+    // the header is serialized with a zero checksum; the checksum is then written into it
+    _header.serialize(header);
+    NetUnparser::store_u16(header + TCPHeader::CKSUM_OFFSET, 0);
 
     // calculate checksum -- taken over entire segment
     InternetChecksum check(datagram_layer_checksum);
-    check.add(header_out.serialize());
-    check.add(_payload);
-    header_out.cksum = check.value();
-
-    BufferList ret;
-    ret.append(header_out.serialize());
-    ret.append(_payload);
+    check.add({header, header_len});
+    const bool summed = _payload_sum.has_value() and _payload_sum->first.str().data() == _payload.str().data() and
+                        _payload_sum->first.size() == _payload.size();
+    if (summed) {
+        check.add(_payload_sum->second);
+        if (copied) {
+            _payload.str().copy(payload, _payload.size());
+        }
+    } else if (copied) {
+        check.add_copy(payload, _payload);
+    } else {
+        check.add(_payload);
+    }
+    NetUnparser::store_u16(header + TCPHeader::CKSUM_OFFSET, check.value());
 
+    BufferList ret{packet};
+    if (not copied) {
+        ret.append(_payload);
+    }
     return ret;
 }
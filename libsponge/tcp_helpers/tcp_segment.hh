@@ -3,20 +3,32 @@
 
 #include "buffer.hh"
 #include "tcp_header.hh"
+#include "util.hh"
 
 #include <cstdint>
+#include <optional>
+#include <utility>
 
 //! \brief [TCP](\ref rfc::rfc793) segment
 class TCPSegment {
+  public:
+    //! Space left in front of a serialized segment for the IPv4 and Ethernet headers
+    static constexpr size_t HEADROOM = 64;
+
+    //! Largest payload that serialize() copies in behind the header (a larger one is sent as a second iovec)
+    static constexpr size_t MAX_COPIED_PAYLOAD = 256;
+
   private:
     TCPHeader _header{};
     Buffer _payload{};
+    //! Checksum of the payload computed when its bytes were gathered, and the Buffer it covers
+    std::optional<std::pair<Buffer, InternetChecksum>> _payload_sum{};
 
   public:
     //! \brief Parse the segment from a string
     ParseResult parse(const Buffer buffer, const uint32_t datagram_layer_checksum = 0);
 
-    //! \brief Serialize the segment to a string
+    //! \brief Serialize the segment, with room in front of the header for lower-layer headers
     BufferList serialize(const uint32_t datagram_layer_checksum = 0) const;
 
     //! \name Accessors
@@ -28,6 +40,11 @@ class TCPSegment {
     Buffer &payload() { return _payload; }
     //!@}
 
+    //! \brief Set the payload along with the checksum of its bytes
+    //! \details serialize() uses the sum instead of reading the payload again, for as long as the
+    //! payload is still this Buffer (e.g. on every retransmission of the segment).
+    void set_payload(Buffer payload, const InternetChecksum &payload_sum);
+
     //! \brief Segment's length in sequence space
     //! \note Equal to payload length plus one byte if SYN is set, plus one byte if FIN is set
     size_t length_in_sequence_space() const;
@@ -30,6 +30,7 @@ void TCPSpongeSocket<AdaptT>::_tcp_loop(const function<bool()> &condition) {
             break;
         }
 
+        _apply_options();
         if (_tcp.value().active()) {
             const auto next_time = timestamp_ms();
             _tcp.value().tick(next_time - base_time);
@@ -39,6 +40,20 @@ void TCPSpongeSocket<AdaptT>::_tcp_loop(const function<bool()> &condition) {
     }
 }
 
+template <typename AdaptT>
+void TCPSpongeSocket<AdaptT>::_apply_options() {
+    const bool cork = _cork.load();
+    if (_applied_cork != cork) {
+        cork ? _tcp->cork() : _tcp->uncork();
+        _applied_cork = cork;
+    }
+    const int nodelay = _nodelay.load();
+    if (nodelay != _applied_nodelay) {
+        _tcp->set_nodelay(nodelay == 1);
+        _applied_nodelay = nodelay;
+    }
+}
+
 //! \param[in] data_socket_pair is a pair of connected AF_UNIX SOCK_STREAM sockets
 //! \param[in] datagram_interface is the interface for reading and writing datagrams
 template <typename AdaptT>
@@ -52,7 +67,17 @@ TCPSpongeSocket<AdaptT>::TCPSpongeSocket(pair<FileDescriptor, FileDescriptor> da
 
 template <typename AdaptT>
 void TCPSpongeSocket<AdaptT>::_initialize_TCP(const TCPConfig &config) {
-    _tcp.emplace(config);
+    // the link decides how much fits in a segment, if the adapter knows its MTU
+    TCPConfig tcp_config{config};
+    if (const size_t mss = _datagram_adapter.mss(); mss > 0) {
+        tcp_config.mss = mss;
+    }
+    _tcp.emplace(tcp_config);
+
+    // with Backend::IOUring, datagrams are received in batches, with room for each header's options (up to 40 bytes)
+    _eventloop.batch_packets(_datagram_adapter,
+                             tcp_config.mss + EthernetHeader::LENGTH +
+                                 2 * (IPv4Header::LENGTH + TCPHeader::MAX_OPTIONS_LENGTH));
 
     // Set up the event loop
 
@@ -96,7 +121,7 @@ void TCPSpongeSocket<AdaptT>::_initialize_TCP(const TCPConfig &config) {
         _thread_data,
         Direction::In,
         [&] {
-            const auto data = _thread_data.read(_tcp->remaining_outbound_capacity());
+            auto data = _thread_data.read(_tcp->remaining_outbound_capacity());
             const auto len = data.size();
             const auto amount_written = _tcp->write(move(data));
             if (amount_written != len) {
@@ -129,8 +154,7 @@ void TCPSpongeSocket<AdaptT>::_initialize_TCP(const TCPConfig &config) {
             // the pipe, handling the possibility of a partial
             // write (i.e., only pop what was actually written).
             const size_t amount_to_write = min(size_t(65536), inbound.buffer_size());
-            const std::string buffer = inbound.peek_output(amount_to_write);
-            const auto bytes_written = _thread_data.write(move(buffer), false);
+            const auto bytes_written = _thread_data.write(inbound.peek_views(amount_to_write), false);
             inbound.pop_output(bytes_written);
 
             if (inbound.eof() or inbound.error()) {
@@ -208,10 +232,10 @@ void TCPSpongeSocket<AdaptT>::connect(const TCPConfig &c_tcp, const FdAdapterCon
         throw runtime_error("connect() with TCPConnection already initialized");
     }
 
-    _initialize_TCP(c_tcp);
-
     _datagram_adapter.config_mut() = c_ad;
 
+    _initialize_TCP(c_tcp);
+
     cerr << "DEBUG: Connecting to " << c_ad.destination.to_string() << "...\n";
     _tcp->connect();
 
@@ -236,11 +260,11 @@ void TCPSpongeSocket<AdaptT>::listen_and_accept(const TCPConfig &c_tcp, const Fd
         throw runtime_error("listen_and_accept() with TCPConnection already initialized");
     }
 
-    _initialize_TCP(c_tcp);
-
     _datagram_adapter.config_mut() = c_ad;
     _datagram_adapter.set_listening(true);
 
+    _initialize_TCP(c_tcp);
+
     cerr << "DEBUG: Listening for incoming connection...\n";
     _tcp_loop([&] {
         const auto s = _tcp->state();
@@ -35,7 +35,7 @@ class TCPSpongeSocket : public LocalStreamSocket {
     std::optional<TCPConnection> _tcp{};
 
     //! eventloop that handles all the events (new inbound datagram, new outbound bytes, new inbound bytes)
-    EventLoop _eventloop{};
+    EventLoop _eventloop{EventLoop::fastest_backend()};
 
     //! Process events while specified condition is true
     void _tcp_loop(const std::function<bool()> &condition);
@@ -57,6 +57,17 @@ class TCPSpongeSocket : public LocalStreamSocket {
 
     bool _fully_acked{false};  //!< Has the outbound data been fully acknowledged by the peer?
 
+    //! \name Socket options set by the owner; the TCPConnection thread applies them on its next pass
+    //!@{
+    std::atomic_bool _cork{false};
+    bool _applied_cork{false};
+    std::atomic_int _nodelay{-1};  //!< -1 until the owner calls set_nodelay(), then 0 or 1
+    int _applied_nodelay{-1};
+    //!@}
+
+    //! Hand changed socket options to the TCPConnection (TCPConnection thread only)
+    void _apply_options();
+
   public:
     //! Construct from the interface that the TCPConnection thread will use to read and write datagrams
     explicit TCPSpongeSocket(AdaptT &&datagram_interface);
@@ -72,6 +83,16 @@ class TCPSpongeSocket : public LocalStreamSocket {
     //! Listen and accept using the specified configurations; blocks until accept succeeds or fails
     void listen_and_accept(const TCPConfig &c_tcp, const FdAdapterConfig &c_ad);
 
+    //! \name Coalescing of small writes (like `TCP_CORK` and `TCP_NODELAY`)
+    //! \note Changes take effect within one tick of the TCPConnection thread.
+    //!@{
+    void cork() { _cork.store(true); }     //!< Hold back partial segments until uncork()
+    void uncork() { _cork.store(false); }  //!< Send what cork() held back
+
+    //! Turn Nagle's algorithm off (`true`) or on (`false`), whatever TCPConfig::nagle said
+    void set_nodelay(const bool nodelay) { _nodelay.store(nodelay ? 1 : 0); }
+    //!@}
+
     //! When a connected socket is destructed, it will send a RST
     ~TCPSpongeSocket();
 
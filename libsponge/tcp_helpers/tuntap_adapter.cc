@@ -19,7 +19,7 @@ TCPOverIPv4OverEthernetAdapter::TCPOverIPv4OverEthernetAdapter(TapFD &&tap,
 optional<TCPSegment> TCPOverIPv4OverEthernetAdapter::read() {
     // Read Ethernet frame from the raw device
     EthernetFrame frame;
-    if (frame.parse(_tap.read()) != ParseResult::NoError) {
+    if (frame.parse(_tap.read_packet()) != ParseResult::NoError) {
         return {};
     }
 
@@ -50,7 +50,7 @@ void TCPOverIPv4OverEthernetAdapter::write(TCPSegment &seg) {
 
 void TCPOverIPv4OverEthernetAdapter::send_pending() {
     while (not _interface.frames_out().empty()) {
-        _tap.write(_interface.frames_out().front().serialize());
+        _tap.write_packet(_interface.frames_out().front().serialize());
         _interface.frames_out().pop();
     }
 }
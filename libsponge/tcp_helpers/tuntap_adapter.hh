@@ -21,14 +21,17 @@ class TCPOverIPv4OverTunFdAdapter : public TCPOverIPv4Adapter {
     //! Attempts to read and parse an IPv4 datagram containing a TCP segment related to the current connection
     std::optional<TCPSegment> read() {
         InternetDatagram ip_dgram;
-        if (ip_dgram.parse(_tun.read()) != ParseResult::NoError) {
+        if (ip_dgram.parse(_tun.read_packet()) != ParseResult::NoError) {
             return {};
         }
         return unwrap_tcp_in_ip(ip_dgram);
     }
 
     //! Creates an IPv4 datagram from a TCP segment and writes it to the TUN device
-    void write(TCPSegment &seg) { _tun.write(wrap_tcp_in_ip(seg).serialize()); }
+    void write(TCPSegment &seg) { _tun.write_packet(wrap_tcp_in_ip(seg).serialize()); }
+
+    //! Largest TCP payload that fits in one datagram on the TUN device
+    size_t mss() const { return _tun.mtu() - HEADERS_LENGTH; }
 
     //! Access the underlying TUN device
     operator TunFD &() { return _tun; }
@@ -66,6 +69,9 @@ class TCPOverIPv4OverEthernetAdapter : public TCPOverIPv4Adapter {
     //! Called periodically when time elapses
     void tick(const size_t ms_since_last_tick);
 
+    //! Largest TCP payload that fits in one frame on the TAP device
+    size_t mss() const { return _tap.mtu() - HEADERS_LENGTH; }
+
     //! Access the underlying raw Ethernet connection
     operator TapFD &() { return _tap; }
 
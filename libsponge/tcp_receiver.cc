@@ -2,6 +2,7 @@
 
 #include "wrapping_integers.hh"
 
+#include <algorithm>
 #include <cstddef>
 
 // Dummy implementation of a TCP receiver
@@ -39,13 +40,60 @@ void TCPReceiver::segment_received(const TCPSegment &seg) {
     size_t index = abs_sn > 0 ? abs_sn - 1 : 0;
 
     // push payload to reassembler
-    _reassembler.push_substring(payload.copy(), index, fin);
+    _reassembler.push_substring(payload.str(), index, fin);
+    if (abs_sn > _expect and _reassembler.unassembled_bytes() > 0) {
+        _latest_ahead = index;
+    }
 
     // update _expect
     _expect = _reassembler.stream_out().bytes_written() + 1 + (_reassembler.stream_out().input_ended() ? 1 : 0);
     _ackno.emplace(wrap(_expect, _isn.value()));
 }
 
+bool TCPReceiver::segment_in_order(const TCPSegment &seg) {
+    const auto &header = seg.header();
+    const size_t size = seg.payload().size();
+    if (header.syn || header.fin || size == 0 || !_ackno.has_value() || header.seqno != _ackno.value() ||
+        size > window_size() || _reassembler.unassembled_bytes() > 0) {
+        return false;
+    }
+
+    // the reassembler appends it to the stream directly, and the ackno moves past it without unwrapping;
+    // a FIN that arrived earlier, out of order, ends the stream here and takes one more sequence number
+    _reassembler.push_substring(seg.payload().str(), _expect - 1, false);
+    const size_t advance = size + (_reassembler.stream_out().input_ended() ? 1 : 0);
+    _expect += advance;
+    _ackno.emplace(_ackno.value() + advance);
+    return true;
+}
+
 optional<WrappingInt32> TCPReceiver::ackno() const { return _ackno; }
 
-size_t TCPReceiver::window_size() const { return _reassembler.stream_out().remaining_capacity(); }
\ No newline at end of file
+size_t TCPReceiver::window_size() const { return _reassembler.stream_out().remaining_capacity(); }
+
+//! \param[in] max_blocks the most blocks to return
+vector<SACKBlock> TCPReceiver::sack_blocks(const size_t max_blocks) const {
+    vector<SACKBlock> blocks;
+    if (not _isn.has_value()) {
+        return blocks;
+    }
+
+    // stream index i is absolute sequence number i + 1 (the SYN comes first)
+    const auto to_block = [&](const pair<uint64_t, uint64_t> &range) {
+        return SACKBlock{wrap(range.first + 1, _isn.value()), wrap(range.second + 1, _isn.value())};
+    };
+    const auto ranges = _reassembler.unassembled_ranges();
+    const auto latest = find_if(ranges.begin(), ranges.end(), [&](const pair<uint64_t, uint64_t> &range) {
+        return _latest_ahead.has_value() and range.first <= _latest_ahead.value() and
+               _latest_ahead.value() < range.second;
+    });
+    if (latest != ranges.end() and max_blocks > 0) {
+        blocks.push_back(to_block(*latest));
+    }
+    for (auto it = ranges.begin(); it != ranges.end() and blocks.size() < max_blocks; ++it) {
+        if (it != latest) {
+            blocks.push_back(to_block(*it));
+        }
+    }
+    return blocks;
+}
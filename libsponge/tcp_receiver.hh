@@ -8,6 +8,7 @@
 
 #include <cstddef>
 #include <optional>
+#include <vector>
 
 //! \brief The "receiver" part of a TCP implementation.
 
@@ -24,6 +25,9 @@ class TCPReceiver {
     std::optional<WrappingInt32> _ackno;
     std::optional<WrappingInt32> _isn;
 
+    //! stream index of the latest segment that arrived ahead of the ackno (its SACK block is reported first)
+    std::optional<uint64_t> _latest_ahead{};
+
   public:
     //! \brief Construct a TCP receiver
     //!
@@ -52,6 +56,11 @@ class TCPReceiver {
     //! accepted by the receiver) and (b) the sequence number of the
     //! beginning of the window (the ackno).
     size_t window_size() const;
+
+    //! \brief [SACK](\ref rfc::rfc2018) blocks for the data held beyond the ackno
+    //!
+    //! The block holding the most recently received segment comes first, then the rest in order.
+    std::vector<SACKBlock> sack_blocks(const size_t max_blocks = TCPHeader::MAX_SACK_BLOCKS) const;
     //!@}
 
     //! \brief number of bytes stored but not yet reassembled
@@ -60,6 +69,12 @@ class TCPReceiver {
     //! \brief handle an inbound segment
     void segment_received(const TCPSegment &seg);
 
+    //! \brief Header-prediction fast path for the next in-order data
+    //! \returns `false`, having changed nothing, unless `seg` has payload but no SYN or FIN, starts at the ackno,
+    //! fits in the window, and nothing is waiting to be reassembled (a FIN already received out of order is
+    //! acknowledged along with the data that reaches it)
+    bool segment_in_order(const TCPSegment &seg);
+
     //! \name "Output" interface for the reader
     //!@{
     ByteStream &stream_out() { return _reassembler.stream_out(); }
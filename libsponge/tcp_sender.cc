@@ -6,11 +6,15 @@
 
 #include <algorithm>
 #include <cassert>
+#include <cmath>
 #include <cstddef>
 #include <cstdint>
 #include <iostream>
 #include <optional>
 #include <random>
+#include <string>
+#include <string_view>
+#include <vector>
 
 // Dummy implementation of a TCP sender
 
@@ -22,63 +26,60 @@ void DUMMY_CODE(Targs &&... /* unused */) {}
 
 using namespace std;
 
-template <typename Index, typename Content>
-void Timers<Index, Content>::start_timer(size_t time, const Index &index, const Content &content) {
-    _timer_list.emplace_back(TimeNode{time, index, content});
-}
-
-template <typename Index, typename Content>
-bool Timers<Index, Content>::remove_timer_before_index(const Index &index) {
-    auto timenode_cmp_by_index = [&index](const TimeNode &node) { return node.index <= index; };
-    auto new_end = remove_if(_timer_list.begin(), _timer_list.end(), timenode_cmp_by_index);
-    bool ret = new_end != _timer_list.end();
-    if (ret) {
-        _timer_list.resize(new_end - _timer_list.begin());
-    }
-    return ret;
-}
-
-template <typename Index, typename Content>
-optional<Content> Timers<Index, Content>::expired_with_min_index(size_t now_time, Index *ret_idx) {
-    optional<Content> ret;
-    auto timenode_cmp_by_time = [now_time, this](const TimeNode &node) {
-        return now_time - node.time >= this->_timeout;
-    };
-    bool is_first(true);
-    auto ret_p = _timer_list.end();
-    for (auto p = _timer_list.begin(); p != _timer_list.end(); p++) {
-        const TimeNode &node = *p;
-        if (timenode_cmp_by_time(node)) {
-            if (is_first || node.index < *ret_idx) {
-                *ret_idx = node.index;
-                ret_p = p;
-                is_first = false;
-            }
-        }
+//! \param[in] rtt a round-trip time measurement, in milliseconds
+void RTTEstimator::add_sample(const size_t rtt) {
+    const auto r = static_cast<double>(rtt);
+    if (not _has_sample) {
+        _srtt = r;
+        _rttvar = r / 2;
+        _has_sample = true;
+        return;
     }
+    _rttvar = 0.75 * _rttvar + 0.25 * abs(_srtt - r);
+    _srtt = 0.875 * _srtt + 0.125 * r;
+}
 
-    if (ret_p != _timer_list.end()) {
-        ret.emplace(ret_p->content);
-        _timer_list.erase(ret_p);
+//! \param[in] min_rto the lower bound on the result, in milliseconds
+//! \details RTO = SRTT + max(G, 4 * RTTVAR), where the clock granularity G is one millisecond.
+size_t RTTEstimator::rto(const size_t min_rto) const {
+    const auto rto = static_cast<size_t>(ceil(_srtt + max(1.0, 4 * _rttvar)));
+    return max(rto, min_rto);
+}
+
+//! \param[in] base segment size to start from; it should work on any path
+//! \param[in] max largest segment size to search up to
+PMTUSearch::PMTUSearch(const size_t base, const size_t max)
+    : _base(min(base, max)), _max(max), _low(_base), _high(max) {}
+
+//! \param[in] now the sender's current time, in milliseconds
+//! \details The first probe tries the largest size outright, since most paths carry whatever the
+//! endpoints' links do; after a failure, the search bisects.
+optional<size_t> PMTUSearch::probe_size(const size_t now) {
+    if (_high < _low + GRANULARITY) {
+        if (not _done_since.has_value()) {
+            _done_since = now;
+        }
+        if (_low == _max or now - _done_since.value() < RAISE_TIMER) {
+            return nullopt;
+        }
+        // the path may have changed since: search again
+        _high = _max;
+        _probe_failed = false;
+        _done_since.reset();
     }
-    return ret;
+    return _probe_failed ? (_low + _high + 1) / 2 : _high;
 }
 
-template <typename Index, typename Content>
-void Timers<Index, Content>::restart_all_timers(size_t now_time) {
-    auto restart_func = [now_time](TimeNode &node) { node.time = now_time; };
-    for_each(_timer_list.begin(), _timer_list.end(), restart_func);
+void PMTUSearch::probe_lost(const size_t size) {
+    _high = min(_high, size - 1);
+    _probe_failed = true;
 }
 
-template <typename Index, typename Content>
-void Timers<Index, Content>::restart_timers_except_min_index(size_t now_time) {
-    auto idx_cmp = [](const TimeNode &a, const TimeNode &b) { return a.index < b.index; };
-    auto min_idx = min_element(_timer_list.begin(), _timer_list.end(), idx_cmp)->index;
-    for_each(_timer_list.begin(), _timer_list.end(), [min_idx, now_time](TimeNode &node) {
-        if (node.index != min_idx) {
-            node.time = now_time;
-        }
-    });
+void PMTUSearch::black_hole() {
+    _high = _low - 1;
+    _low = _base;
+    _probe_failed = true;
+    _done_since.reset();
 }
 
 //! \param[in] capacity the capacity of the outgoing byte stream
@@ -88,13 +89,45 @@ TCPSender::TCPSender(const size_t capacity, const uint16_t retx_timeout, const s
     : _isn(fixed_isn.value_or(WrappingInt32{random_device()()}))
     , _initial_retransmission_timeout{retx_timeout}
     , _rto{_initial_retransmission_timeout}
-    , _stream(capacity)
-    , _timers(_rto) {}
+    , _stream(capacity, ByteStream::Storage::Chunked)
+    , _timer(_rto) {}
+
+//! \param[in] cfg the connection's configuration (capacity, timeouts, ISN, RTO estimation, congestion control,
+//! segment size)
+TCPSender::TCPSender(const TCPConfig &cfg) : TCPSender(cfg.send_capacity, cfg.rt_timeout, cfg.fixed_isn) {
+    _adaptive_rto = cfg.adaptive_rto;
+    _min_rto = cfg.min_rto;
+    _congestion_control = cfg.congestion_control;
+    _max_mss = cfg.mss;
+    _nagle = cfg.nagle;
+    if (cfg.pmtu_discovery) {
+        _pmtu.emplace(TCPConfig::MAX_PAYLOAD_SIZE, _max_mss);
+    }
+    _congestion = make_congestion_controller(_congestion_control, segment_size());
+}
+
+//! \param[in] mss the largest payload the peer will accept
+//! \details The congestion controller starts over, so that its initial window is in terms of the new size.
+void TCPSender::set_peer_mss(const size_t mss) {
+    _max_mss = min(_max_mss, mss);
+    if (_pmtu.has_value()) {
+        _pmtu.emplace(TCPConfig::MAX_PAYLOAD_SIZE, _max_mss);
+    }
+    _congestion = make_congestion_controller(_congestion_control, segment_size());
+}
 
 uint64_t TCPSender::bytes_in_flight() const { return _next_seqno - _ack_seqno; }
 
 void TCPSender::fill_window() {
-    size_t window_size = _window_size.value_or(0);
+    // send no more than the peer's window, nor more than the congestion window allows in flight
+    const size_t peer_window = _window_size.value_or(0);
+    size_t window_size = peer_window;
+    if (_congestion) {
+        const size_t cwnd = _congestion->cwnd();
+        const size_t in_network = pipe();
+        window_size = min(window_size, cwnd > in_network ? cwnd - in_network : 0);
+    }
+    const size_t usable_window = window_size;
     auto remain_size = _stream.buffer_size();
     bool syn_tmp{_syn};
 
@@ -103,71 +136,413 @@ void TCPSender::fill_window() {
         seg.header().syn = _syn;
         seg.header().seqno = next_seqno();
 
-        auto payload_size = min(window_size - (_syn ? 1 : 0), min(remain_size, TCPConfig::MAX_PAYLOAD_SIZE));
+        // probe for a larger segment size, one probe at a time, when there's data and window to fill it
+        size_t max_payload = segment_size();
+        if (_pmtu.has_value() && !_probe.has_value() && !_syn && !_in_recovery) {
+            const auto probe_size = _pmtu->probe_size(_now_time);
+            if (probe_size.has_value() && remain_size >= probe_size.value() && window_size >= probe_size.value()) {
+                max_payload = probe_size.value();
+                _probe = _next_seqno;
+            }
+        }
+
+        // a tail shorter than a full segment waits while corked, or under Nagle while data is unacknowledged,
+        // unless it ends the stream
+        if (!_syn && remain_size < max_payload && !_stream.input_ended() &&
+            (_corked || (_nagle && bytes_in_flight() > 0))) {
+            break;
+        }
+
+        auto payload_size = min(window_size - (_syn ? 1 : 0), min(remain_size, max_payload));
         _fin = _stream.input_ended() && (payload_size == remain_size) && (window_size > payload_size + (_syn ? 1 : 0));
         seg.header().fin = _fin;
-        seg.payload() = Buffer(_stream.read(payload_size));
-
-        _segments_out.emplace(seg);
+        // the payload is a slice of the stream's chunk, shared by the queued and the outstanding copy of the
+        // segment and kept until it's acknowledged; only a payload that straddles two chunks is copied.
+        // Its checksum is taken here, during that copy, and reused each time the segment is serialized.
+        const BufferList payload = _stream.read_buffers(payload_size);
+        InternetChecksum payload_sum;
+        if (payload.buffers().size() > 1) {
+            Buffer bytes = Buffer::allocate(payload_size);
+            char *dest = bytes.prepend(payload_size);
+            for (const Buffer &piece : payload.buffers()) {
+                payload_sum.add_copy(dest, piece);
+                dest += piece.size();
+            }
+            seg.set_payload(bytes, payload_sum);
+        } else {
+            const Buffer piece{payload};
+            payload_sum.add(piece);
+            seg.set_payload(piece, payload_sum);
+        }
+        const size_t seg_len = seg.length_in_sequence_space();
 
-        _next_seqno += seg.length_in_sequence_space();
-        _timers.start_timer(_now_time, _next_seqno, seg);
+        _segments_out.push(seg);
+        _outstanding.push_back({_next_seqno, move(seg), _now_time, false});
+        if (!_timer.running()) {
+            _timer.start(_now_time);
+        }
+        _next_seqno += seg_len;
 
-        window_size -= seg.length_in_sequence_space();
+        window_size -= seg_len;
         remain_size -= payload_size;
         _syn = false;
     }
     if (!syn_tmp) {
-        _window_size.emplace(window_size);
+        _window_size.emplace(peer_window - (usable_window - window_size));
+    }
+}
+
+void TCPSender::retransmit_front() {
+    if (_probe == _outstanding.front().seqno) {
+        probe_lost();
+        return;
+    }
+    split_front(segment_size());
+    _segments_out.emplace(_outstanding.front().segment);
+    _outstanding.front().retransmitted = true;
+    _outstanding.front().resent = true;
+}
+
+size_t TCPSender::split_front(const size_t size) {
+    const OutstandingSegment front = _outstanding.front();
+    const Buffer &payload = front.segment.payload();
+    if (payload.size() <= size) {
+        return 1;
+    }
+    _outstanding.pop_front();
+
+    const TCPHeader &header = front.segment.header();
+    vector<OutstandingSegment> pieces;
+    uint64_t seqno = front.seqno;
+    for (size_t offset = 0; offset < payload.size(); offset += size) {
+        TCPSegment piece;
+        piece.header().syn = header.syn && offset == 0;
+        piece.header().fin = header.fin && offset + size >= payload.size();
+        piece.header().seqno = wrap(seqno, _isn);
+        piece.payload() = payload.substr(offset, size);
+        pieces.push_back({seqno, piece, front.sent_time, front.retransmitted});
+        pieces.back().lost = front.lost;
+        seqno += piece.length_in_sequence_space();
+    }
+    _outstanding.insert(_outstanding.begin(), pieces.begin(), pieces.end());
+    return pieces.size();
+}
+
+//! \details A lost probe most likely means the segment was too big for the path, not that the path
+//! is congested, so the congestion window stays as it is. As after a timeout, duplicate ACKs for
+//! data sent so far can't start a fast recovery.
+void TCPSender::probe_lost() {
+    _pmtu->probe_lost(_outstanding.front().segment.payload().size());
+    _probe.reset();
+    const size_t pieces = split_front(segment_size());
+    for (size_t i = 0; i < pieces; i++) {
+        _segments_out.emplace(_outstanding[i].segment);
+        _outstanding[i].retransmitted = true;
+        _outstanding[i].resent = true;
+    }
+    _dupacks = 0;
+    if (!_in_recovery) {
+        _recover = _next_seqno;
+    }
+}
+
+//! \param[in] ack_seqno the new cumulative ACK; `_ack_seqno` still holds the previous one
+//! \param[in] acked_bytes payload bytes in the segments it acknowledged
+void TCPSender::ack_advanced(const uint64_t ack_seqno, const size_t acked_bytes) {
+    _dupacks = 0;
+    if (_in_recovery) {
+        if (ack_seqno >= _recover) {
+            _in_recovery = false;
+            _congestion->exit_recovery(_next_seqno - ack_seqno);
+        } else if (_sack) {
+            retransmit_lost();
+        } else {
+            // partial ACK: the segment after the one we retransmitted was lost too (RFC 6582, section 3.2)
+            retransmit_front();
+            _congestion->deflate(ack_seqno - _ack_seqno);
+        }
+        return;
+    }
+
+    // only payload bytes open the congestion window; SYN and FIN don't
+    if (acked_bytes > 0) {
+        const auto srtt = _rtt.has_sample() ? make_optional(_rtt.srtt()) : nullopt;
+        _congestion->on_ack(acked_bytes, _now_time, srtt);
+    }
+
+    // after a timeout with SACK, keep resending what was outstanding then, as fast as slow start allows
+    if (_rto_recovery) {
+        if (ack_seqno >= _recover) {
+            _rto_recovery = false;
+        } else {
+            retransmit_lost();
+        }
+    }
+}
+
+void TCPSender::duplicate_ack() {
+    _dupacks++;
+    if (_rto_recovery) {
+        // newly SACKed segments leave room in the pipe
+        retransmit_lost();
+        return;
+    }
+    if (_in_recovery) {
+        if (_sack) {
+            retransmit_lost();
+        } else {
+            // each further duplicate means another segment has left the network
+            _congestion->inflate(_congestion->mss());
+        }
+        return;
+    }
+    // don't start a second recovery for losses from before the last one (or the last timeout)
+    const bool loss = _dupacks >= DUPACK_THRESHOLD || (_sack && _outstanding.front().lost);
+    if (loss && _ack_seqno > _recover) {
+        if (_probe == _outstanding.front().seqno) {
+            probe_lost();
+            return;
+        }
+        _in_recovery = true;
+        _recover = _next_seqno;
+        _congestion->on_loss(bytes_in_flight(), _now_time);
+        retransmit_front();
+        if (_sack) {
+            // the scoreboard's pipe estimate replaces window inflation (RFC 6675, section 5)
+            retransmit_lost();
+        } else {
+            _congestion->inflate(DUPACK_THRESHOLD * _congestion->mss());
+        }
+    }
+}
+
+//! \param[in] blocks the SACK blocks from the peer's segment
+void TCPSender::sack_received(const vector<SACKBlock> &blocks) {
+    if (!_sack) {
+        return;
+    }
+    bool changed = false;
+    for (const auto &block : blocks) {
+        const uint64_t begin = unwrap(block.begin, _isn, _ack_seqno);
+        const uint64_t end = unwrap(block.end, _isn, _ack_seqno);
+        if (begin >= end || end > _next_seqno) {
+            continue;
+        }
+        for (auto &out : _outstanding) {
+            if (!out.sacked && out.seqno >= begin && out.seqno + out.segment.length_in_sequence_space() <= end) {
+                out.sacked = true;
+                changed = true;
+            }
+        }
+    }
+    if (changed) {
+        update_lost();
+    }
+}
+
+//! \details A segment is lost once DupThresh segments, or more than (DupThresh - 1) * MSS bytes,
+//! above it have been SACKed. After a timeout, everything sent before it stays lost until SACKed.
+void TCPSender::update_lost() {
+    size_t sacked_segments = 0;
+    size_t sacked_bytes = 0;
+    for (auto it = _outstanding.rbegin(); it != _outstanding.rend(); ++it) {
+        if (it->sacked) {
+            sacked_segments++;
+            sacked_bytes += it->segment.length_in_sequence_space();
+            it->lost = false;
+        } else {
+            it->lost = (_rto_recovery && it->seqno < _recover) || sacked_segments >= DUPACK_THRESHOLD ||
+                       sacked_bytes > (DUPACK_THRESHOLD - 1) * (_congestion ? _congestion->mss() : segment_size());
+        }
+    }
+}
+
+//! \details Each byte that isn't SACKed counts once if it isn't deemed lost, and once more
+//! if a retransmission of it is in the network.
+size_t TCPSender::pipe() const {
+    if (!(_sack && _in_recovery) && !_rto_recovery) {
+        return bytes_in_flight();
+    }
+    size_t pipe = 0;
+    for (const auto &out : _outstanding) {
+        if (out.sacked) {
+            continue;
+        }
+        const size_t len = out.segment.length_in_sequence_space();
+        pipe += (out.lost ? 0 : len) + (out.resent ? len : 0);
+    }
+    return pipe;
+}
+
+//! \details Without a congestion controller, only the receiver's window (which they're inside) limits them.
+void TCPSender::retransmit_lost() {
+    size_t in_network = _congestion ? pipe() : 0;
+    for (auto &out : _outstanding) {
+        if (out.sacked || !out.lost || out.resent) {
+            continue;
+        }
+        const size_t len = out.segment.length_in_sequence_space();
+        if (_congestion && in_network + len > _congestion->cwnd()) {
+            break;
+        }
+        _segments_out.emplace(out.segment);
+        out.retransmitted = true;
+        out.resent = true;
+        in_network += len;
     }
 }
 
 //! \param ackno The remote receiver's ackno (acknowledgment number)
-//! \param window_size The remote receiver's advertised window size
-void TCPSender::ack_received(const WrappingInt32 ackno, const uint16_t window_size) {
+//! \param window_size The remote receiver's advertised window size, in bytes
+//! \param pure_ack Whether the segment that carried the ACK had no payload, SYN or FIN
+void TCPSender::ack_received(const WrappingInt32 ackno, const uint32_t window_size, const bool pure_ack) {
     auto ack_seqno = unwrap(ackno, _isn, _next_seqno);
     if (ack_seqno <= _next_seqno) {
-        auto is_remove = _timers.remove_timer_before_index(ack_seqno);
-        // is_remove is true: one or more tcp segments have received.
-        // Otherwise, ack is repeat or not the full segment has received,
-        // maybe it need to resend the segment.
-        if (is_remove) {
-            _timers.restart_all_timers(_now_time);
-        } else {
-            _timers.restart_timers_except_min_index(_now_time);
+        const bool duplicate = _congestion && pure_ack && ack_seqno == _ack_seqno && ack_seqno > 0 &&
+                               !_outstanding.empty() && window_size == _peer_window;
+
+        // drop the segments that are now fully acknowledged. If there were any, the timer restarts for
+        // the oldest remaining segment (RFC 6298, 5.2 and 5.3). Otherwise, ack is repeat or not the full
+        // segment has received, and the oldest segment keeps its running timer.
+        const bool is_remove = pop_acked(ack_seqno);
+        if (!is_remove && duplicate) {
+            duplicate_ack();
+        }
+        // without a congestion controller to run a recovery, what the SACK blocks show lost is resent now
+        if (_sack && !_congestion) {
+            retransmit_lost();
         }
 
         // when at least one segment has received, set the window size.
         // `_ack_seqno == ack_seqno` means that a segment with bigger index has
         // received.
         if (is_remove || _ack_seqno == ack_seqno) {
-            _ack_seqno = ack_seqno;
-            _is_zero_win = window_size == 0;
-            const auto actual_win_size = window_size >= bytes_in_flight() ? window_size - bytes_in_flight() : 0;
-            _window_size.emplace(_is_zero_win ? 1 : actual_win_size);
+            window_update(ack_seqno, window_size);
+        }
+    }
+}
+
+//! \details Header prediction: outside loss recovery and path MTU probing, an ACK that acknowledges
+//! one or more whole segments needs none of ack_received()'s checks for duplicates, probes and SYNs.
+bool TCPSender::fast_ack(const WrappingInt32 ackno, const uint32_t window_size) {
+    if (_in_recovery || _rto_recovery || _probe.has_value() || _outstanding.empty()) {
+        return false;
+    }
+    const int32_t advance = ackno - wrap(_ack_seqno, _isn);
+    const uint64_t ack_seqno = _ack_seqno + advance;
+    const OutstandingSegment *front = &_outstanding.front();
+    if (advance <= 0 || ack_seqno > _next_seqno ||
+        front->seqno + front->segment.length_in_sequence_space() > ack_seqno) {
+        return false;
+    }
+
+    pop_acked(ack_seqno);
+    window_update(ack_seqno, window_size);
+    return true;
+}
+
+bool TCPSender::ack_unchanged(const WrappingInt32 ackno, const uint32_t window_size) const {
+    return ackno == wrap(_ack_seqno, _isn) && window_size == _peer_window;
+}
+
+//! \details The segments are at the front of the queue. The RTT is sampled from the last of them, unless
+//! the ACK also covers a retransmission: then it can't be timed by any of them (Karn's rule).
+bool TCPSender::pop_acked(const uint64_t ack_seqno) {
+    bool ambiguous = false;
+    optional<size_t> rtt_sample{};
+    size_t acked_bytes = 0;
+    size_t acked_segments = 0;
+    while (!_outstanding.empty() &&
+           _outstanding.front().seqno + _outstanding.front().segment.length_in_sequence_space() <= ack_seqno) {
+        const auto &acked = _outstanding.front();
+        if (_probe == acked.seqno) {
+            _pmtu->probe_acked(acked.segment.payload().size());
+            _probe.reset();
+            if (_congestion) {
+                _congestion->set_mss(segment_size());
+            }
         }
+        ambiguous |= acked.retransmitted;
+        rtt_sample = ambiguous ? nullopt : make_optional(_now_time - acked.sent_time);
+        acked_bytes += acked.segment.payload().size();
+        acked_segments++;
+        _outstanding.pop_front();
+    }
+    if (acked_segments == 0) {
+        return false;
+    }
+    segments_acked(ack_seqno, acked_bytes, rtt_sample);
+    return true;
+}
+
+void TCPSender::segments_acked(const uint64_t ack_seqno, const size_t acked_bytes, const optional<size_t> rtt_sample) {
+    if (rtt_sample.has_value()) {
+        _rtt.add_sample(rtt_sample.value());
+    }
+    if (_congestion) {
+        ack_advanced(ack_seqno, acked_bytes);
+    }
+    // an adaptive RTO that was backed off stays so until a valid sample replaces it (Karn's algorithm)
+    if (!_adaptive_rto) {
         _rto = _initial_retransmission_timeout;
-        _timers.set_timeout(_rto);
-        _retx = 0;
+    } else if (rtt_sample.has_value()) {
+        _rto = _rtt.rto(_min_rto);
+    }
+    _timer.set_timeout(_rto);
+    _retx = 0;
+    if (_outstanding.empty()) {
+        _timer.stop();
+    } else {
+        _timer.start(_now_time);
     }
 }
 
+void TCPSender::window_update(const uint64_t ack_seqno, const uint32_t window_size) {
+    _ack_seqno = ack_seqno;
+    _peer_window = window_size;
+    _is_zero_win = window_size == 0;
+    const auto actual_win_size = window_size >= bytes_in_flight() ? window_size - bytes_in_flight() : 0;
+    _window_size.emplace(_is_zero_win ? 1 : actual_win_size);
+}
+
 //! \param[in] ms_since_last_tick the number of milliseconds since the last call to this method
 void TCPSender::tick(const size_t ms_since_last_tick) {
     _now_time += ms_since_last_tick;
 
-    uint64_t index{0};
-    auto expired_seg = _timers.expired_with_min_index(_now_time, &index);
-
-    if (expired_seg.has_value()) {
-        _segments_out.emplace(expired_seg.value());
-        _timers.start_timer(_now_time, index, expired_seg.value());
+    if (_timer.expired(_now_time) && !_outstanding.empty()) {
+        if (_probe == _outstanding.front().seqno) {
+            probe_lost();
+            _timer.start(_now_time);
+            return;
+        }
+        // full-size segments that keep timing out may be falling into a PMTU black hole
+        if (_pmtu.has_value() && _retx + 1 >= PMTU_BLACK_HOLE_RETX &&
+            _outstanding.front().segment.payload().size() > _pmtu->base()) {
+            _pmtu->black_hole();
+            if (_congestion) {
+                _congestion->set_mss(segment_size());
+            }
+        }
+        if (!_is_zero_win && _congestion) {
+            _congestion->on_timeout(bytes_in_flight(), _now_time);
+            _in_recovery = false;
+            _recover = _next_seqno;
+            _dupacks = 0;
+            // the receiver may have discarded what it SACKed (RFC 2018, section 8); with SACK, everything
+            // outstanding is presumed lost, earlier retransmissions included, and resent as slow start allows
+            _rto_recovery = _sack;
+            for (auto &out : _outstanding) {
+                out.sacked = out.resent = false;
+                out.lost = _sack;
+            }
+        }
+        retransmit_front();
         if (!_is_zero_win) {
             _rto <<= 1;
-            _timers.set_timeout(_rto);
+            _timer.set_timeout(_rto);
             _retx++;
         }
-        _timers.restart_all_timers(_now_time);
+        _timer.start(_now_time);
     }
 }
 
@@ -180,5 +555,4 @@ void TCPSender::send_empty_segment() {
     seg.header().seqno = next_seqno();
     _segments_out.emplace(seg);
     _next_seqno += seg.length_in_sequence_space();
-    // _timers.start_timer(_now_time, _next_seqno, seg);
 }
@@ -2,39 +2,99 @@
 #define SPONGE_LIBSPONGE_TCP_SENDER_HH
 
 #include "byte_stream.hh"
+#include "congestion_control.hh"
 #include "tcp_config.hh"
 #include "tcp_segment.hh"
 #include "wrapping_integers.hh"
 
+#include <algorithm>
 #include <cstddef>
 #include <cstdint>
 #include <deque>
-#include <functional>
+#include <memory>
 #include <optional>
 #include <queue>
 #include <vector>
 
-// Timer
-template <typename Index, typename Content>
-class Timers {
-    using TimeNode = struct __time_node {
-        size_t time{};
-        Index index{};
-        Content content{};
-    };
+//! \brief A single retransmission timer (see [RFC 6298](\ref rfc::rfc6298))
+class RetxTimer {
     size_t _timeout;
-    std::deque<TimeNode> _timer_list{};
+    size_t _start_time{0};
+    bool _running{false};
 
   public:
-    Timers<Index, Content>(size_t timeout) : _timeout(timeout) {}
+    RetxTimer(size_t timeout) : _timeout(timeout) {}
     void set_timeout(size_t timeout) { _timeout = timeout; }
-    size_t get_timeout() { return _timeout; }
+    size_t get_timeout() const { return _timeout; }
 
-    void start_timer(size_t time, const Index &index, const Content &content);
-    bool remove_timer_before_index(const Index &index);
-    std::optional<Content> expired_with_min_index(size_t now_time, Index *ret_idx);
-    void restart_all_timers(size_t now_time);
-    void restart_timers_except_min_index(size_t now_time);
+    void start(size_t now_time) {
+        _start_time = now_time;
+        _running = true;
+    }
+    void stop() { _running = false; }
+    bool running() const { return _running; }
+    bool expired(size_t now_time) const { return _running && now_time - _start_time >= _timeout; }
+};
+
+//! \brief Smoothed round-trip time estimator (see [RFC 6298](\ref rfc::rfc6298), section 2)
+class RTTEstimator {
+    double _srtt{0};
+    double _rttvar{0};
+    bool _has_sample{false};
+
+  public:
+    //! Fold a new round-trip time measurement, in milliseconds, into the estimate
+    void add_sample(const size_t rtt);
+
+    //! Whether any measurement has been taken yet
+    bool has_sample() const { return _has_sample; }
+
+    //! Smoothed round-trip time, in milliseconds
+    double srtt() const { return _srtt; }
+
+    //! Round-trip time variation, in milliseconds
+    double rttvar() const { return _rttvar; }
+
+    //! Retransmission timeout implied by the estimate, but no less than `min_rto`
+    size_t rto(const size_t min_rto) const;
+};
+
+//! \brief Packetization-layer path MTU discovery ([RFC 4821](\ref rfc::rfc4821)), measured in segment payload sizes
+
+//! The search starts from a size that should work on any path and probes
+//! upward with single larger segments. An acknowledged probe raises the
+//! size in use; a lost one lowers the upper end of the search.
+class PMTUSearch {
+    size_t _base;                         //!< size assumed to work on any path
+    size_t _max;                          //!< largest size the peer and the local link allow
+    size_t _low;                          //!< largest size known to get through; the one in use
+    size_t _high;                         //!< largest size not yet known to fail
+    bool _probe_failed{false};            //!< once a probe has failed, bisect rather than trying `_high`
+    std::optional<size_t> _done_since{};  //!< when the search last converged
+
+  public:
+    static constexpr size_t GRANULARITY = 32;      //!< search ends when fewer bytes than this are left to gain
+    static constexpr size_t RAISE_TIMER = 600000;  //!< ms before searching again for a larger size
+
+    PMTUSearch(const size_t base, const size_t max);
+
+    //! Segment size to use for everything but probes
+    size_t mss() const { return _low; }
+
+    //! Size the search started from
+    size_t base() const { return _base; }
+
+    //! Size of the next probe, unless the search has converged and it's not yet time to start another one
+    std::optional<size_t> probe_size(const size_t now);
+
+    //! A probe of `size` bytes was acknowledged
+    void probe_acked(const size_t size) { _low = std::max(_low, size); }
+
+    //! A probe of `size` bytes was lost
+    void probe_lost(const size_t size);
+
+    //! Segments of the current size keep being lost: fall back to the base size and search again
+    void black_hole();
 };
 
 //! \brief The "sender" part of a TCP implementation.
@@ -58,24 +118,110 @@ class TCPSender {
     //! outgoing stream of bytes that have not yet been sent
     ByteStream _stream;
 
-    Timers<uint64_t, TCPSegment> _timers;
+    RetxTimer _timer;
+
+    //! round-trip time estimate, updated on ACKs for segments that were sent only once
+    RTTEstimator _rtt{};
+    bool _adaptive_rto{false};
+    size_t _min_rto{TCPConfig::MIN_RTO_DFLT};
+
+    //! congestion control, if any; it caps bytes_in_flight() at its cwnd
+    std::unique_ptr<CongestionController> _congestion{};
+
+    //! duplicate ACKs that trigger a fast retransmit ([RFC 5681](\ref rfc::rfc5681), section 3.2)
+    static constexpr unsigned int DUPACK_THRESHOLD = 3;
+
+    //! duplicate-ACK counting and NewReno fast recovery; only used with congestion control
+    uint32_t _peer_window{0};   //!< window advertised with the last acceptable ACK
+    unsigned int _dupacks{0};   //!< duplicate ACKs since the cumulative ACK last advanced
+    bool _in_recovery{false};   //!< whether a fast recovery is under way
+    uint64_t _recover{0};       //!< highest seqno sent when the last fast recovery or timeout began
+    bool _sack{false};          //!< the peer sends SACK blocks, so recovery follows [RFC 6675](\ref rfc::rfc6675)
+    bool _rto_recovery{false};  //!< with SACK, resending (in slow start) what was outstanding at the last timeout
+
+    //! segment sizing: the peer's MSS and the local link bound it, and path MTU discovery (if on) picks within that
+    TCPConfig::CongestionControl _congestion_control{TCPConfig::CongestionControl::None};
+    size_t _max_mss{TCPConfig::MAX_PAYLOAD_SIZE};  //!< largest payload the peer accepts and our link carries
+    std::optional<PMTUSearch> _pmtu{};             //!< path MTU search, if enabled
+    std::optional<uint64_t> _probe{};              //!< absolute seqno of the outstanding probe, if any
+
+    //! consecutive timeouts of a segment larger than the base size that suggest a PMTU black hole
+    static constexpr unsigned int PMTU_BLACK_HOLE_RETX = 2;
+
+    //! coalescing of small writes: a short tail of the stream waits for more data (or an ACK, with Nagle)
+    bool _nagle{false};   //!< hold the tail while data is unacknowledged ([RFC 896](\ref rfc::rfc896))
+    bool _corked{false};  //!< hold the tail until uncorked
+
+    //! a segment that has been sent but not yet fully acknowledged
+    struct OutstandingSegment {
+        uint64_t seqno;      //!< absolute sequence number of the segment's first byte
+        TCPSegment segment;  //!< the segment as it was sent
+        size_t sent_time;    //!< when the segment was first sent
+        bool retransmitted;  //!< whether the segment has been resent (Karn's rule: don't time it)
+        bool sacked{false};  //!< whether the receiver reported holding it in a SACK block
+        bool lost{false};    //!< whether it's deemed lost: by the SACK scoreboard (RFC 6675, IsLost) or a timeout
+        bool resent{false};  //!< whether a retransmission of it is presumed to be in the network
+    };
+
+    //! segments in flight, oldest first; the timer always refers to the front one
+    std::deque<OutstandingSegment> _outstanding{};
 
     //! the (absolute) sequence number for the next byte to be sent
     uint64_t _next_seqno{0};
     uint64_t _ack_seqno{0};
     size_t _now_time{0};
     uint32_t _retx{0};
-    std::optional<uint16_t> _window_size{};
+    std::optional<uint32_t> _window_size{};
     bool _is_zero_win{false};
     bool _syn{true};
     bool _fin{false};
 
+    //! resend the oldest outstanding segment, in smaller pieces if it no longer fits the segment size
+    void retransmit_front();
+
+    //! split the oldest outstanding segment into segments of at most `size` bytes of payload
+    //! \returns how many segments it became
+    size_t split_front(const size_t size);
+
+    //! the probe at the front of the queue was lost: search lower and resend its data at the current size
+    void probe_lost();
+
+    //! drop the segments that an ACK up to `ack_seqno` acknowledges in full, and pass them to segments_acked()
+    //! \returns whether there were any
+    bool pop_acked(const uint64_t ack_seqno);
+
+    //! an ACK up to `ack_seqno` removed whole segments: take the RTT sample, tell congestion control,
+    //! and restart the timer for the oldest remaining segment
+    void segments_acked(const uint64_t ack_seqno, const size_t acked_bytes, const std::optional<size_t> rtt_sample);
+
+    //! record the cumulative ACK and the peer's window from an acceptable ACK
+    void window_update(const uint64_t ack_seqno, const uint32_t window_size);
+
+    //! tell the congestion controller that the cumulative ACK advanced to `ack_seqno`
+    void ack_advanced(const uint64_t ack_seqno, const size_t acked_bytes);
+
+    //! count a duplicate ACK; the third in a row starts fast retransmit and fast recovery
+    void duplicate_ack();
+
+    //! recompute which outstanding segments the SACK scoreboard deems lost
+    void update_lost();
+
+    //! estimate of the bytes still in the network; in SACK recovery, or after a timeout with SACK, RFC 6675's "pipe"
+    size_t pipe() const;
+
+    //! during SACK recovery, or after a timeout with SACK, resend lost segments while the congestion window
+    //! (if there is one) allows
+    void retransmit_lost();
+
   public:
     //! Initialize a TCPSender
     TCPSender(const size_t capacity = TCPConfig::DEFAULT_CAPACITY,
               const uint16_t retx_timeout = TCPConfig::TIMEOUT_DFLT,
               const std::optional<WrappingInt32> fixed_isn = {});
 
+    //! Initialize a TCPSender from a connection's configuration
+    explicit TCPSender(const TCPConfig &cfg);
+
     //! \name "Input" interface for the writer
     //!@{
     ByteStream &stream_in() { return _stream; }
@@ -86,7 +232,32 @@ class TCPSender {
     //!@{
 
     //! \brief A new acknowledgment was received
-    void ack_received(const WrappingInt32 ackno, const uint16_t window_size);
+    //! \note Only an ACK that carried no payload, SYN or FIN (`pure_ack`) can count as a duplicate ACK.
+    //! \note `window_size` is in bytes, already scaled by the peer's window-scale shift.
+    void ack_received(const WrappingInt32 ackno, const uint32_t window_size, const bool pure_ack = true);
+
+    //! \brief Header-prediction fast path for an ACK of new data outside loss recovery
+    //! \returns `false`, having changed nothing, if the ACK needs ack_received()
+    bool fast_ack(const WrappingInt32 ackno, const uint32_t window_size);
+
+    //! \brief Whether an ACK acknowledges nothing new and repeats the last window (so ack_received() is a no-op)
+    bool ack_unchanged(const WrappingInt32 ackno, const uint32_t window_size) const;
+
+    //! \brief The peer agreed to send [SACK](\ref rfc::rfc2018) blocks
+    void enable_sack() { _sack = true; }
+
+    //! \brief SACK blocks arrived; call before ack_received() for the same segment
+    //! \note Without congestion control, the segments the scoreboard deems lost are resent by ack_received().
+    void sack_received(const std::vector<SACKBlock> &blocks);
+
+    //! \brief The peer's MSS option (or the default, if its SYN had none); call before sending any data
+    void set_peer_mss(const size_t mss);
+
+    //! \brief Turn Nagle's algorithm on or off
+    void set_nagle(const bool nagle) { _nagle = nagle; }
+
+    //! \brief While corked, send only full segments and the end of the stream; call fill_window() after uncorking
+    void set_cork(const bool cork) { _corked = cork; }
 
     //! \brief Generate an empty-payload segment (useful for creating empty ACK segments)
     void send_empty_segment();
@@ -109,6 +280,27 @@ class TCPSender {
     //! \brief Number of consecutive retransmissions that have occurred in a row
     unsigned int consecutive_retransmissions() const;
 
+    //! \brief The current round-trip time estimate
+    const RTTEstimator &rtt_estimate() const { return _rtt; }
+
+    //! \brief The current retransmission timeout, in milliseconds
+    size_t retransmission_timeout() const { return _rto; }
+
+    //! \brief Largest payload the sender may ever put in a segment
+    size_t max_segment_size() const { return _max_mss; }
+
+    //! \brief Payload size of full segments right now (path MTU discovery may not have reached the maximum)
+    size_t segment_size() const { return _pmtu.has_value() ? _pmtu->mss() : _max_mss; }
+
+    //! \brief Whether Nagle's algorithm is on
+    bool nagle() const { return _nagle; }
+
+    //! \brief Whether the sender is corked
+    bool corked() const { return _corked; }
+
+    //! \brief The congestion controller, or nullptr if sending is limited only by the peer's window
+    const CongestionController *congestion_controller() const { return _congestion.get(); }
+
     //! \brief TCPSegments that the TCPSender has enqueued for transmission.
     //! \note These must be dequeued and sent by the TCPConnection,
     //! which will need to fill in the fields that are set by the TCPReceiver
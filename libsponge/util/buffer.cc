@@ -1,18 +1,170 @@
 #include "buffer.hh"
 
+#include <array>
+#include <new>
+
 using namespace std;
 
+namespace {
+
+//! Bytes in each size class of the pool; blocks of class 0 hold just the header of a Buffer built from a string
+constexpr array<size_t, 4> size_classes{0, Buffer::TINY_BLOCK, Buffer::SMALL_BLOCK, Buffer::LARGE_BLOCK};
+
+//! Most blocks of each class that a thread keeps for reuse; any more are freed
+constexpr array<size_t, 4> max_free_blocks{1024, 1024, 256, 16};
+
+//! \returns the smallest size class holding `n` bytes, or size_classes.size() if none does
+size_t size_class(const size_t n) {
+    size_t cls = 0;
+    while (cls < size_classes.size() and size_classes[cls] < n) {
+        cls++;
+    }
+    return cls;
+}
+
+//! \brief One thread's free lists of blocks, linked through the blocks themselves
+//! \note A block goes back to the pool of the thread that frees it, which needn't be the one that allocated it.
+class PacketPool {
+  private:
+    struct FreeBlock {
+        FreeBlock *next;
+    };
+
+    array<FreeBlock *, size_classes.size()> _free{};
+    array<size_t, size_classes.size()> _free_count{};
+
+  public:
+    PacketPool() = default;
+    ~PacketPool();
+
+    PacketPool(const PacketPool &other) = delete;
+    PacketPool &operator=(const PacketPool &other) = delete;
+
+    void *allocate(const size_t cls, const size_t block_size) {
+        if (cls == size_classes.size() or not _free[cls]) {
+            return ::operator new(block_size);
+        }
+        FreeBlock *const block = _free[cls];
+        _free[cls] = block->next;
+        _free_count[cls]--;
+        return block;
+    }
+
+    void release(void *block, const size_t cls) {
+        if (cls == size_classes.size() or _free_count[cls] == max_free_blocks[cls]) {
+            ::operator delete(block);
+            return;
+        }
+        _free[cls] = new (block) FreeBlock{_free[cls]};
+        _free_count[cls]++;
+    }
+};
+
+//! Set once this thread's pool is gone, so that Buffers destroyed after it (e.g. statics) free their blocks
+thread_local bool pool_destroyed = false;
+
+PacketPool::~PacketPool() {
+    for (auto &list : _free) {
+        while (list) {
+            ::operator delete(exchange(list, list->next));
+        }
+    }
+    pool_destroyed = true;
+}
+
+//! \returns this thread's pool, or nullptr if the thread is exiting and has destroyed it already
+PacketPool *local_pool() {
+    if (pool_destroyed) {
+        return nullptr;
+    }
+    thread_local PacketPool pool;
+    return &pool;
+}
+
+}  // namespace
+
+//! \param[in] pooled is the number of bytes to allocate after the header, rounded up to a size class
+//! \param[in] owned is the string holding the bytes instead, if `pooled` is 0
+Buffer::Storage *Buffer::make_storage(const size_t pooled, string &&owned) {
+    const size_t cls = size_class(pooled);
+    const size_t bytes = cls < size_classes.size() ? size_classes[cls] : pooled;
+    const size_t block_size = sizeof(Storage) + bytes;
+    PacketPool *const pool = local_pool();
+    void *const block = pool ? pool->allocate(cls, block_size) : ::operator new(block_size);
+
+    Storage *const storage = new (block) Storage{1, false, bytes, 0, move(owned), nullptr};
+    storage->bytes = bytes ? reinterpret_cast<char *>(storage + 1) : storage->owned.data();
+    return storage;
+}
+
+void Buffer::destroy_storage(Storage *storage) {
+    const size_t cls = size_class(storage->pooled);
+    storage->~Storage();
+    PacketPool *const pool = local_pool();
+    if (pool) {
+        pool->release(storage, cls);
+    } else {
+        ::operator delete(storage);
+    }
+}
+
+//! \param[in] str the string to own
+//! \param[in] headroom how many bytes at the start of `str` are space rather than contents
+Buffer::Buffer(string &&str, const size_t headroom) {
+    if (headroom > str.size()) {
+        throw out_of_range("Buffer: headroom larger than the string");
+    }
+    _starting_offset = headroom;
+    _length = str.size() - headroom;
+    _storage = make_storage(0, move(str));
+    _storage->front = headroom;
+}
+
+//! \param[in] capacity the number of bytes that the Buffer can prepend() (more, if it's rounded up)
+Buffer Buffer::allocate(const size_t capacity) {
+    Buffer ret;
+    ret._storage = make_storage(max<size_t>(capacity, 1), {});
+    ret._starting_offset = ret._storage->front = ret._storage->pooled;
+    return ret;
+}
+
 void Buffer::remove_prefix(const size_t n) {
     if (n > str().size()) {
         throw out_of_range("Buffer::remove_prefix");
     }
     _starting_offset += n;
-    if (_storage and _starting_offset == _storage->size()) {
-        _storage.reset();
+    _length -= n;
+    if (_length == 0) {
+        release();
+    }
+}
+
+void Buffer::remove_suffix(const size_t n) {
+    if (n > str().size()) {
+        throw out_of_range("Buffer::remove_suffix");
+    }
+    _length -= n;
+    if (_length == 0) {
+        release();
+    }
+}
+
+Buffer Buffer::substr(const size_t pos, const size_t len) const {
+    if (pos > size()) {
+        throw out_of_range("Buffer::substr");
     }
+    const size_t length = min(len, size() - pos);
+    if (length == 0) {
+        return {};
+    }
+    Buffer ret{*this};
+    ret._starting_offset = _starting_offset + pos;
+    ret._length = length;
+    return ret;
 }
 
 void BufferList::append(const BufferList &other) {
+    _buffers.reserve(_buffers.size() + other._buffers.size());
     for (const auto &buf : other._buffers) {
         _buffers.push_back(buf);
     }
@@ -48,42 +200,88 @@ size_t BufferList::size() const {
     return ret;
 }
 
+char *Buffer::prepend(const size_t n) {
+    if (n > headroom()) {
+        throw out_of_range("Buffer::prepend");
+    }
+    _starting_offset -= n;
+    _length += n;
+    _storage->front = _starting_offset;
+    return _storage->bytes + _starting_offset;
+}
+
+BufferList &BufferList::share_between_threads() {
+    for (auto &buf : _buffers) {
+        buf.share_between_threads();
+    }
+    return *this;
+}
+
+BufferList BufferList::slice(size_t pos, size_t len) const {
+    if (pos > size()) {
+        throw out_of_range("BufferList::slice");
+    }
+    BufferList ret;
+    for (auto it = _buffers.begin(); it != _buffers.end() and len > 0; ++it) {
+        if (pos >= it->size()) {
+            pos -= it->size();
+            continue;
+        }
+        ret._buffers.push_back(it->substr(pos, len));
+        len -= min(len, ret._buffers.back().size());
+        pos = 0;
+    }
+    return ret;
+}
+
 void BufferList::remove_prefix(size_t n) {
+    // the Buffers used up are erased all at once, since that moves the rest down
+    size_t used_up = 0;
     while (n > 0) {
-        if (_buffers.empty()) {
+        if (used_up == _buffers.size()) {
             throw std::out_of_range("BufferList::remove_prefix");
         }
 
-        if (n < _buffers.front().str().size()) {
-            _buffers.front().remove_prefix(n);
+        if (n < _buffers[used_up].str().size()) {
+            _buffers[used_up].remove_prefix(n);
             n = 0;
         } else {
-            n -= _buffers.front().str().size();
-            _buffers.pop_front();
+            n -= _buffers[used_up].str().size();
+            used_up++;
         }
     }
+    _buffers.erase_front(used_up);
 }
 
 BufferViewList::BufferViewList(const BufferList &buffers) {
+    _views.reserve(buffers.buffers().size());
     for (const auto &x : buffers.buffers()) {
         _views.push_back(x);
     }
 }
 
+void BufferViewList::append(string_view str) {
+    if (not str.empty()) {
+        _views.push_back(str);
+    }
+}
+
 void BufferViewList::remove_prefix(size_t n) {
+    size_t used_up = 0;
     while (n > 0) {
-        if (_views.empty()) {
+        if (used_up == _views.size()) {
             throw std::out_of_range("BufferListView::remove_prefix");
         }
 
-        if (n < _views.front().size()) {
-            _views.front().remove_prefix(n);
+        if (n < _views[used_up].size()) {
+            _views[used_up].remove_prefix(n);
             n = 0;
         } else {
-            n -= _views.front().size();
-            _views.pop_front();
+            n -= _views[used_up].size();
+            used_up++;
         }
     }
+    _views.erase_front(used_up);
 }
 
 size_t BufferViewList::size() const {
@@ -94,8 +292,8 @@ size_t BufferViewList::size() const {
     return ret;
 }
 
-vector<iovec> BufferViewList::as_iovecs() const {
-    vector<iovec> ret;
+SmallVector<iovec, BufferViewList::INLINE_CAPACITY> BufferViewList::as_iovecs() const {
+    SmallVector<iovec, INLINE_CAPACITY> ret;
     ret.reserve(_views.size());
     for (const auto &x : _views) {
         ret.push_back({const_cast<char *>(x.data()), x.size()});
@@ -1,27 +1,120 @@
 #ifndef SPONGE_LIBSPONGE_BUFFER_HH
 #define SPONGE_LIBSPONGE_BUFFER_HH
 
+#include "small_vector.hh"
+
 #include <algorithm>
-#include <deque>
-#include <memory>
 #include <numeric>
 #include <stdexcept>
 #include <string>
 #include <string_view>
 #include <sys/uio.h>
-#include <vector>
+#include <utility>
 
 //! \brief A reference-counted read-only string that can discard bytes from the front
+//! \note Copies share the storage; each copy is a view of some range of it.
+//! \details A Buffer can also be built with headroom: space reserved in front of its bytes, into which
+//! prepend() adds bytes in place (e.g. the headers of the lower layers of a packet). The headroom is
+//! handed out at most once: only a Buffer that starts where the bytes in use start can prepend.
+//!
+//! The storage comes from a per-thread pool of blocks in a few fixed size classes, each block a reference
+//! count followed by its bytes, so that a packet that is allocate()d, filled in and freed again doesn't
+//! call malloc once the pool is warm. A Buffer built from a std::string keeps the string and takes just
+//! the header block from the pool.
+//!
+//! The reference count is a plain integer unless share_between_threads() has been called: a Buffer and
+//! its copies belong to one thread at a time. They can be handed to another thread along with whatever
+//! holds them (e.g. a TCPConnection moving to TCPSpongeSocket's thread), as long as the hand-off itself
+//! synchronizes, but copies can't be made or dropped on two threads at once until the Buffer is shared.
 class Buffer {
   private:
-    std::shared_ptr<std::string> _storage{};
+    //! The bytes that Buffers share, and the number of Buffers sharing them
+    struct Storage {
+        size_t refs;        //!< Number of Buffers that share this Storage
+        bool atomic;        //!< Whether `refs` is updated with atomic instructions (see share_between_threads())
+        size_t pooled;      //!< Number of bytes in the block after this header; 0 if they're `owned`
+        size_t front;       //!< Start of the bytes in use; everything before it is unclaimed headroom
+        std::string owned;  //!< The string a Buffer was built from, if it was
+        char *bytes;        //!< Everything allocated, including any headroom
+    };
+
+    Storage *_storage{};
     size_t _starting_offset{};
+    size_t _length{};  //!< Number of bytes viewed, starting at `_starting_offset`
+
+    //! Storage for `pooled` bytes from the pool, or else for the bytes of `owned`
+    static Storage *make_storage(const size_t pooled, std::string &&owned);
+
+    //! Return the Storage to the pool once its last Buffer lets go of it
+    static void destroy_storage(Storage *storage);
+
+    void retain() {
+        if (not _storage) {
+            return;
+        }
+        if (_storage->atomic) {
+            __atomic_fetch_add(&_storage->refs, 1, __ATOMIC_RELAXED);
+        } else {
+            _storage->refs++;
+        }
+    }
+
+    void release() {
+        if (not _storage) {
+            return;
+        }
+        const size_t refs =
+            _storage->atomic ? __atomic_sub_fetch(&_storage->refs, 1, __ATOMIC_ACQ_REL) : --_storage->refs;
+        if (refs == 0) {
+            destroy_storage(_storage);
+        }
+        _storage = nullptr;
+    }
 
   public:
+    //! \name Size classes of the pool, in bytes
+    //! Requests are rounded up to one of these; larger ones are allocated (and freed) individually.
+    //!@{
+    static constexpr size_t TINY_BLOCK = 256;     //!< e.g. headers, and segments with no payload
+    static constexpr size_t SMALL_BLOCK = 2048;   //!< an Ethernet-sized packet
+    static constexpr size_t LARGE_BLOCK = 65536;  //!< the largest datagram
+    //!@}
+
     Buffer() = default;
 
     //! \brief Construct by taking ownership of a string
-    Buffer(std::string &&str) noexcept : _storage(std::make_shared<std::string>(std::move(str))) {}
+    Buffer(std::string &&str) noexcept
+        : _storage(make_storage(0, std::move(str))), _length(_storage->owned.size()) {}
+
+    //! \brief Construct by taking ownership of a string whose first `headroom` bytes are reserved for prepend()
+    Buffer(std::string &&str, const size_t headroom);
+
+    //! \brief An empty Buffer at the end of (at least) `capacity` bytes of pooled storage, all of them headroom
+    //! \details The caller fills the Buffer in from the back with prepend(), or from the front with
+    //! `prepend(capacity)` and then remove_suffix() of whatever was left over.
+    static Buffer allocate(const size_t capacity);
+
+    //! \name Copies share the storage
+    //!@{
+    Buffer(const Buffer &other) noexcept
+        : _storage(other._storage), _starting_offset(other._starting_offset), _length(other._length) {
+        retain();
+    }
+
+    Buffer(Buffer &&other) noexcept
+        : _storage(std::exchange(other._storage, nullptr))
+        , _starting_offset(std::exchange(other._starting_offset, 0))
+        , _length(std::exchange(other._length, 0)) {}
+
+    Buffer &operator=(Buffer other) noexcept {
+        std::swap(_storage, other._storage);
+        std::swap(_starting_offset, other._starting_offset);
+        std::swap(_length, other._length);
+        return *this;
+    }
+
+    ~Buffer() { release(); }
+    //!@}
 
     //! \name Expose contents as a std::string_view
     //!@{
@@ -29,7 +122,7 @@ class Buffer {
         if (not _storage) {
             return {};
         }
-        return {_storage->data() + _starting_offset, _storage->size() - _starting_offset};
+        return {_storage->bytes + _starting_offset, _length};
     }
 
     operator std::string_view() const { return str(); }
@@ -47,6 +140,31 @@ class Buffer {
     //! \brief Discard the first `n` bytes of the string (does not require a copy or move)
     //! \note Doesn't free any memory until the whole string has been discarded in all copies of the Buffer.
     void remove_prefix(const size_t n);
+
+    //! \brief Discard the last `n` bytes of the string
+    void remove_suffix(const size_t n);
+
+    //! \brief A Buffer of (at most) `len` bytes starting at `pos`, sharing this one's storage
+    //! \note Like std::string_view::substr, throws std::out_of_range if `pos` is past the end.
+    Buffer substr(const size_t pos, const size_t len = std::string::npos) const;
+
+    //! \brief Number of bytes that prepend() can add
+    size_t headroom() const { return _storage and _storage->front == _starting_offset ? _starting_offset : 0; }
+
+    //! \brief Grow the Buffer into its headroom by `n` bytes, which the caller then fills in
+    //! \returns a pointer to the `n` new bytes at the front
+    //! \note Throws std::out_of_range if `n` is more than headroom().
+    char *prepend(const size_t n);
+
+    //! \brief Let copies of this Buffer be made and dropped on several threads at once, from now on
+    //! \details Makes the reference count of the storage atomic. Call it on the thread that the Buffer
+    //! belongs to, before the copies go to other threads. Storage stays shared until its last copy is gone.
+    Buffer &share_between_threads() {
+        if (_storage) {
+            _storage->atomic = true;
+        }
+        return *this;
+    }
 };
 
 //! \brief A reference-counted discontiguous string that can discard bytes from the front
@@ -55,8 +173,12 @@ class Buffer {
 //! encapsulate a TCP payload in a TCPSegment, and then encapsulate
 //! the TCPSegment in an IPv4Datagram) without copying the payload.
 class BufferList {
+  public:
+    //! Number of Buffers held without allocating: enough for the headers of each layer and a payload
+    static constexpr size_t INLINE_CAPACITY = 4;
+
   private:
-    std::deque<Buffer> _buffers{};
+    SmallVector<Buffer, INLINE_CAPACITY> _buffers{};
 
   public:
     //! \name Constructors
@@ -65,17 +187,14 @@ class BufferList {
     BufferList() = default;
 
     //! \brief Construct from a Buffer
-    BufferList(Buffer buffer) : _buffers{buffer} {}
+    BufferList(Buffer buffer) { _buffers.push_back(std::move(buffer)); }
 
     //! \brief Construct by taking ownership of a std::string
-    BufferList(std::string &&str) noexcept {
-        Buffer buf{std::move(str)};
-        append(buf);
-    }
+    BufferList(std::string &&str) noexcept { _buffers.emplace_back(std::move(str)); }
     //!@}
 
-    //! \brief Access the underlying queue of Buffers
-    const std::deque<Buffer> &buffers() const { return _buffers; }
+    //! \brief Access the underlying sequence of Buffers
+    const SmallVector<Buffer, INLINE_CAPACITY> &buffers() const { return _buffers; }
 
     //! \brief Append a BufferList
     void append(const BufferList &other);
@@ -87,21 +206,35 @@ class BufferList {
     //! \brief Discard the first `n` bytes of the string (does not require a copy or move)
     void remove_prefix(size_t n);
 
+    //! \brief A BufferList of (at most) `len` bytes starting at `pos`, sharing this one's storage
+    //! \note Throws std::out_of_range if `pos` is past the end.
+    BufferList slice(const size_t pos, const size_t len = std::string::npos) const;
+
     //! \brief Size of the string
     size_t size() const;
 
     //! \brief Make a copy to a new std::string
     std::string concatenate() const;
+
+    //! \brief Let copies of the Buffers be made and dropped on several threads at once (see Buffer)
+    BufferList &share_between_threads();
 };
 
 //! \brief A non-owning temporary view (similar to std::string_view) of a discontiguous string
 class BufferViewList {
-    std::deque<std::string_view> _views{};
+  public:
+    //! Number of views held (and iovecs exported) without allocating
+    static constexpr size_t INLINE_CAPACITY = 8;
+
+  private:
+    SmallVector<std::string_view, INLINE_CAPACITY> _views{};
 
   public:
     //! \name Constructors
     //!@{
 
+    BufferViewList() = default;
+
     //! \brief Construct from a std::string
     BufferViewList(const std::string &str) : BufferViewList(std::string_view(str)) {}
 
@@ -112,19 +245,22 @@ class BufferViewList {
     BufferViewList(const BufferList &buffers);
 
     //! \brief Construct from a std::string_view
-    BufferViewList(std::string_view str) { _views.push_back({const_cast<char *>(str.data()), str.size()}); }
+    BufferViewList(std::string_view str) { _views.push_back(str); }
     //!@}
 
+    //! \brief Append a std::string_view (empty views are skipped)
+    void append(std::string_view str);
+
     //! \brief Discard the first `n` bytes of the string (does not require a copy or move)
     void remove_prefix(size_t n);
 
     //! \brief Size of the string
     size_t size() const;
 
-    //! \brief Convert to a vector of `iovec` structures
+    //! \brief Convert to a vector of `iovec` structures, which only allocates past INLINE_CAPACITY views
     //! \note used for system calls that write discontiguous buffers,
     //! e.g. [writev(2)](\ref man2::writev) and [sendmsg(2)](\ref man2::sendmsg)
-    std::vector<iovec> as_iovecs() const;
+    SmallVector<iovec, INLINE_CAPACITY> as_iovecs() const;
 };
 
 #endif  // SPONGE_LIBSPONGE_BUFFER_HH
@@ -2,6 +2,11 @@
 
 #include "util.hh"
 
+#ifdef SPONGE_IO_URING
+#include "io_uring.hh"
+#endif
+
+#include <algorithm>
 #include <cerrno>
 #include <stdexcept>
 #include <system_error>
@@ -14,11 +19,44 @@ unsigned int EventLoop::Rule::service_count() const {
     return direction == Direction::In ? fd.read_count() : fd.write_count();
 }
 
+//! \param[in] backend is how to wait for the rules' file descriptors
+EventLoop::EventLoop(const Backend backend) : _backend(backend) {
+    if (_backend == Backend::Epoll) {
+        _epoll.emplace(SystemCall("epoll_create1", ::epoll_create1(EPOLL_CLOEXEC)));
+        _ready.resize(64);
+    } else if (_backend == Backend::IOUring) {
+#ifdef SPONGE_IO_URING
+        _io_uring = make_shared<IOUring>();
+#else
+        throw runtime_error("EventLoop: built without io_uring support (configure with -DSPONGE_IO_URING=ON)");
+#endif
+    }
+}
+
+//! \details The answer is worked out once, by trying to set up an io_uring instance.
+EventLoop::Backend EventLoop::fastest_backend() {
+#ifdef SPONGE_IO_URING
+    static const bool io_uring_works = [] {
+        try {
+            IOUring{};
+            return true;
+        } catch (const unix_error &) {
+            return false;
+        }
+    }();
+    if (io_uring_works) {
+        return Backend::IOUring;
+    }
+#endif
+    return Backend::Epoll;
+}
+
 //! \param[in] fd is the FileDescriptor to be polled
 //! \param[in] direction indicates whether to poll for reading (Direction::In) or writing (Direction::Out)
 //! \param[in] callback is called when `fd` is ready.
 //! \param[in] interest is called by EventLoop::wait_next_event. If it returns `true`, `fd` will
 //!                     be polled, otherwise `fd` will be ignored only for this execution of `wait_next_event.
+//!                     If it is empty, `fd` is always polled.
 //! \param[in] cancel is called when the rule is cancelled (e.g. on hangup, EOF, or closure).
 void EventLoop::add_rule(const FileDescriptor &fd,
                          const Direction direction,
@@ -26,6 +64,106 @@ void EventLoop::add_rule(const FileDescriptor &fd,
                          const InterestT &interest,
                          const CallbackT &cancel) {
     _rules.push_back({fd.duplicate(), direction, callback, interest, cancel});
+    if (_backend != Backend::Epoll) {
+        return;
+    }
+
+    // a rule with an interest callback is registered for its events once the callback asks for them
+    const RuleIterator rule = prev(_rules.end());
+    if (rule->interest) {
+        rule->interested = false;
+        _watched.push_back(rule);
+    } else {
+        _unconditional.push_back(rule);
+    }
+
+    const int fd_num = rule->fd.fd_num();
+    Registration &registration = _registrations[fd_num];
+
+    // rules for an earlier fd with the same number are stale (closing that fd took it out of the epoll set)
+    const auto stale_end = partition(registration.rules.begin(), registration.rules.end(), [](const auto &other) {
+        return not other->fd.closed();
+    });
+    if (stale_end != registration.rules.end()) {
+        for_each(stale_end, registration.rules.end(), [&](const auto &other) { cancel_rule(other); });
+        registration.rules.erase(stale_end, registration.rules.end());
+        registration.added = not registration.rules.empty();
+    }
+
+    registration.rules.push_back(rule);
+    update_registration(fd_num, registration);
+}
+
+void EventLoop::cancel_rule(const RuleIterator rule) {
+    if (rule->canceled) {
+        return;
+    }
+    rule->canceled = true;
+    _canceled.push_back(rule);
+    rule->cancel();
+}
+
+void EventLoop::update_registration(const int fd_num, Registration &registration) {
+    uint32_t events = 0;
+    for (const auto &rule : registration.rules) {
+        if (rule->interested and not rule->canceled) {
+            events |= static_cast<uint32_t>(rule->direction);
+        }
+    }
+    if (registration.added and events == registration.events) {
+        return;
+    }
+
+    epoll_event event{};
+    event.events = events;
+    event.data.fd = fd_num;
+    SystemCall("epoll_ctl",
+               ::epoll_ctl(_epoll->fd_num(), registration.added ? EPOLL_CTL_MOD : EPOLL_CTL_ADD, fd_num, &event));
+    registration.events = events;
+    registration.added = true;
+}
+
+void EventLoop::sweep_canceled() {
+    // NOTE: _canceled can grow in the loop body
+    for (size_t i = 0; i < _canceled.size(); i++) {
+        const RuleIterator rule = _canceled[i];
+        const int fd_num = rule->fd.fd_num();
+        const auto it = _registrations.find(fd_num);
+        if (it != _registrations.end()) {
+            auto &rules = it->second.rules;
+            const auto pos = find(rules.begin(), rules.end(), rule);
+            if (pos != rules.end()) {
+                rules.erase(pos);
+
+                // the other rules for a closed fd can't be waited for either
+                if (rule->fd.closed()) {
+                    for_each(rules.begin(), rules.end(), [&](const auto &other) { cancel_rule(other); });
+                    rules.clear();
+                }
+
+                if (rules.empty()) {
+                    // (a closed fd has already left the epoll set)
+                    if (it->second.added and not rule->fd.closed()) {
+                        SystemCall("epoll_ctl", ::epoll_ctl(_epoll->fd_num(), EPOLL_CTL_DEL, fd_num, nullptr));
+                    }
+                    _registrations.erase(it);
+                } else {
+                    update_registration(fd_num, it->second);
+                }
+            }
+        }
+    }
+
+    if (not _canceled.empty()) {
+        const auto is_canceled = [](const auto &rule) { return rule->canceled; };
+        _watched.erase(remove_if(_watched.begin(), _watched.end(), is_canceled), _watched.end());
+        _unconditional.erase(remove_if(_unconditional.begin(), _unconditional.end(), is_canceled),
+                             _unconditional.end());
+        for (const auto &rule : _canceled) {
+            _rules.erase(rule);
+        }
+        _canceled.clear();
+    }
 }
 
 //! \param[in] timeout_ms is the timeout value passed to [poll(2)](\ref man2::poll); `wait_next_event`
@@ -39,6 +177,9 @@ void EventLoop::add_rule(const FileDescriptor &fd,
 //!
 //! Next, this function calls [poll(2)](\ref man2::poll) with timeout value `timeout_ms`.
 //!
+//! (This describes Backend::Poll. Backend::Epoll does the same, except that it only calls the Rule::interest
+//! callbacks and waits with [epoll_wait(2)](\ref man2::epoll_wait); see wait_with_epoll().)
+//!
 //! Then, for each ready file descriptor, this function calls Rule::callback. If fd reaches EOF or
 //! if the Rule was registered using EventLoop::add_cancelable_rule and Rule::callback returns true,
 //! this Rule is canceled.
@@ -59,12 +200,23 @@ void EventLoop::add_rule(const FileDescriptor &fd,
 //! will result in a busy loop (poll returns on a ready file descriptor; file descriptor is not read or
 //! written, so it is still ready; the next call to poll will immediately return).
 EventLoop::Result EventLoop::wait_next_event(const int timeout_ms) {
+    switch (_backend) {
+        case Backend::Epoll:
+            return wait_with_epoll(timeout_ms);
+        case Backend::IOUring:
+            return wait_with_io_uring(timeout_ms);
+        default:
+            return wait_with_poll(timeout_ms);
+    }
+}
+
+EventLoop::Result EventLoop::wait_with_poll(const int timeout_ms) {
     vector<pollfd> pollfds{};
     pollfds.reserve(_rules.size());
     bool something_to_poll = false;
 
     // set up the pollfd for each rule
-    for (auto it = _rules.cbegin(); it != _rules.cend();) {  // NOTE: it gets erased or incremented in loop body
+    for (auto it = _rules.begin(); it != _rules.end();) {  // NOTE: it gets erased or incremented in loop body
         const auto &this_rule = *it;
         if (this_rule.direction == Direction::In && this_rule.fd.eof()) {
             // no more reading on this rule, it's reached eof
@@ -79,7 +231,7 @@ EventLoop::Result EventLoop::wait_next_event(const int timeout_ms) {
             continue;
         }
 
-        if (this_rule.interest()) {
+        if (it->check_interest()) {
             pollfds.push_back({this_rule.fd.fd_num(), static_cast<short>(this_rule.direction), 0});
             something_to_poll = true;
         } else {
@@ -132,7 +284,7 @@ EventLoop::Result EventLoop::wait_next_event(const int timeout_ms) {
             this_rule.callback();
 
             // only check for busy wait if we're not canceling or exiting
-            if (count_before == this_rule.service_count() and this_rule.interest()) {
+            if (count_before == this_rule.service_count() and it->check_interest()) {
                 throw runtime_error(
                     "EventLoop: busy wait detected: callback did not read/write fd and is still interested");
             }
@@ -143,3 +295,226 @@ EventLoop::Result EventLoop::wait_next_event(const int timeout_ms) {
 
     return Result::Success;
 }
+
+//! Does the same as wait_with_poll(), except that the rules are only visited before waiting to ask the interest
+//! callbacks (and update the events their fds are registered for) and to cancel defunct rules, and only the
+//! ready fds after it.
+EventLoop::Result EventLoop::wait_with_epoll(const int timeout_ms) {
+    // ask each rule with an interest callback, unless its fd can't be waited for any more
+    bool something_to_poll = false;
+    for (size_t i = 0; i < _watched.size(); i++) {  // NOTE: a callback could add a rule
+        const RuleIterator rule = _watched[i];
+        if (not rule->canceled and rule->defunct()) {
+            cancel_rule(rule);
+        } else if (not rule->canceled) {
+            something_to_poll |= rule->check_interest();
+        }
+    }
+    // the rules without one are only checked for an fd that can't be waited for (a closed fd leaves the
+    // epoll set, so it would never be reported)
+    for (size_t i = 0; i < _unconditional.size(); i++) {  // NOTE: a cancel callback could add a rule
+        const RuleIterator rule = _unconditional[i];
+        if (not rule->canceled and rule->defunct()) {
+            cancel_rule(rule);
+        }
+    }
+    sweep_canceled();
+    for (const auto &rule : _watched) {
+        const int fd_num = rule->fd.fd_num();
+        update_registration(fd_num, _registrations.at(fd_num));
+    }
+
+    // quit if there is nothing left to poll
+    if (not something_to_poll and _unconditional.empty()) {
+        return Result::Exit;
+    }
+
+    int ready_count = 0;
+    try {
+        ready_count =
+            SystemCall("epoll_wait", ::epoll_wait(_epoll->fd_num(), _ready.data(), _ready.size(), timeout_ms));
+    } catch (unix_error const &e) {
+        if (e.code().value() == EINTR) {
+            return Result::Exit;
+        }
+        throw;
+    }
+    if (ready_count == 0) {
+        return Result::Timeout;
+    }
+
+    // go through the ready fds, and the rules for each
+    for (int i = 0; i < ready_count; i++) {
+        const uint32_t revents = _ready[i].events;
+        if (revents & EPOLLERR) {
+            throw runtime_error("EventLoop: error on polled file descriptor");
+        }
+
+        // (the fd may have been closed by an earlier callback, but this loop only cancels rules)
+        const auto registration = _registrations.find(_ready[i].data.fd);
+        if (registration == _registrations.end()) {
+            continue;
+        }
+        const auto &rules = registration->second.rules;
+        for (size_t j = 0, rule_count = rules.size(); j < rule_count; j++) {  // NOTE: a callback could add a rule
+            const RuleIterator rule = rules[j];
+            if (rule->canceled) {
+                continue;
+            }
+            if (rule->defunct()) {
+                // e.g. another rule for the same fd read it to EOF
+                cancel_rule(rule);
+                continue;
+            }
+
+            const uint32_t events = rule->interested ? static_cast<uint32_t>(rule->direction) : 0;
+            const bool ready = revents & events;
+            if ((revents & EPOLLHUP) and events and not ready) {
+                // as with poll, a hangup and nothing else means this fd is defunct
+                cancel_rule(rule);
+                continue;
+            }
+
+            if (ready) {
+                const auto count_before = rule->service_count();
+                rule->callback();
+
+                // only check for busy wait if we're not canceling or exiting
+                if (count_before == rule->service_count() and rule->check_interest()) {
+                    throw runtime_error(
+                        "EventLoop: busy wait detected: callback did not read/write fd and is still interested");
+                }
+                if (rule->defunct()) {
+                    cancel_rule(rule);
+                }
+            }
+        }
+    }
+
+    return Result::Success;
+}
+
+#ifdef SPONGE_IO_URING
+void EventLoop::batch_packets(const FileDescriptor &fd, const size_t max_packet_size) {
+    if (_io_uring) {
+        _io_uring->add_packet_source(fd, max_packet_size);
+    }
+}
+
+//! Does the same as wait_with_poll(), except that it waits with an IOUring, whose polls are one-shot
+//! (so a rule's poll is only armed again once it has completed). The rules for fds given to batch_packets()
+//! aren't polled: an In rule is ready while the IOUring holds a packet for it (and its callback is called
+//! once per packet), and an Out rule is always ready, since its writes are queued.
+EventLoop::Result EventLoop::wait_with_io_uring(const int timeout_ms) {
+    auto cancel = [&](Rule &rule) {
+        rule.canceled = true;
+        rule.cancel();
+        if (rule.armed) {
+            _io_uring->cancel_poll(&rule);
+        }
+    };
+    auto call = [&](Rule &rule) {
+        const auto count_before = rule.service_count();
+        rule.callback();
+
+        // only check for busy wait if we're not canceling or exiting
+        const bool serviced = count_before != rule.service_count();
+        if (rule.check_interest() and not serviced) {
+            throw runtime_error(
+                "EventLoop: busy wait detected: callback did not read/write fd and is still interested");
+        }
+        if (rule.defunct()) {
+            cancel(rule);
+        }
+    };
+    auto batched = [&](const Rule &rule) { return rule.fd.packet_batcher() == _io_uring.get(); };
+
+    // arm a poll for each interested rule (a canceled one is erased once its poll has completed)
+    bool something_to_poll = false, batched_ready = false;
+    for (auto it = _rules.begin(); it != _rules.end();) {  // NOTE: it gets erased or incremented in loop body
+        Rule &rule = *it;
+        if (not rule.canceled and rule.defunct()) {
+            cancel(rule);
+        }
+        if (rule.canceled) {
+            it = rule.armed ? next(it) : _rules.erase(it);
+            continue;
+        }
+
+        if (rule.check_interest()) {
+            something_to_poll = true;
+            if (batched(rule)) {
+                batched_ready |= rule.direction == Direction::Out or _io_uring->has_packet(rule.fd);
+            } else if (not rule.armed) {
+                _io_uring->arm_poll(rule.fd.fd_num(), static_cast<short>(rule.direction), &rule);
+                rule.armed = true;
+            }
+        }
+        ++it;
+    }
+
+    // quit if there is nothing left to poll
+    if (not something_to_poll) {
+        return Result::Exit;
+    }
+
+    size_t completions = 0;
+    try {
+        completions = _io_uring->wait(batched_ready ? 0 : timeout_ms);
+    } catch (unix_error const &e) {
+        if (e.code().value() == EINTR) {
+            return Result::Exit;
+        }
+        throw;
+    }
+
+    // go through the polls that completed
+    bool called = false;
+    for (const auto &poll : _io_uring->polls()) {
+        Rule &rule = *static_cast<Rule *>(poll.token);
+        rule.armed = false;
+        if (rule.canceled or poll.result == -ECANCELED) {
+            continue;
+        }
+        if (poll.result < 0 or (poll.result & (POLLERR | POLLNVAL))) {
+            throw runtime_error("EventLoop: error on polled file descriptor");
+        }
+
+        const int events = rule.interested ? static_cast<int>(rule.direction) : 0;
+        const bool ready = poll.result & events;
+        if ((poll.result & POLLHUP) and events and not ready) {
+            // as with poll, a hangup and nothing else means this fd is defunct
+            cancel(rule);
+            continue;
+        }
+        if (ready) {
+            call(rule);
+            called = true;
+        }
+    }
+
+    // then the rules for batched fds: one call per packet received, or one call to queue writes
+    for (auto &rule : _rules) {
+        if (rule.canceled or not rule.interested or not batched(rule)) {
+            continue;
+        }
+        if (rule.direction == Direction::Out) {
+            call(rule);
+            called = true;
+            continue;
+        }
+        while (not rule.canceled and rule.interested and _io_uring->has_packet(rule.fd)) {
+            call(rule);
+            called = true;
+        }
+    }
+
+    return called or completions > 0 ? Result::Success : Result::Timeout;
+}
+#else
+void EventLoop::batch_packets(const FileDescriptor &, const size_t) {}
+
+EventLoop::Result EventLoop::wait_with_io_uring(const int) {
+    throw runtime_error("EventLoop: built without io_uring support");
+}
+#endif
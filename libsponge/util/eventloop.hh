@@ -3,10 +3,18 @@
 
 #include "file_descriptor.hh"
 
+#include <cstdint>
 #include <cstdlib>
 #include <functional>
 #include <list>
+#include <memory>
+#include <optional>
 #include <poll.h>
+#include <sys/epoll.h>
+#include <unordered_map>
+#include <vector>
+
+class IOUring;
 
 //! Waits for events on file descriptors and executes corresponding callbacks.
 class EventLoop {
@@ -17,43 +25,108 @@ class EventLoop {
         Out = POLLOUT  //!< Callback will be triggered when Rule::fd is writable.
     };
 
+    //! How an EventLoop waits for its file descriptors
+    enum class Backend {
+        Epoll,   //!< Register each fd with [epoll(7)](\ref man7::epoll) once; a wait costs O(ready fds)
+        Poll,    //!< Build a [poll(2)](\ref man2::poll) set from every Rule on each wait
+        IOUring  //!< Poll, and batch_packets(), with an IOUring (if built with SPONGE_IO_URING); see the class doc
+    };
+
+    //! Returned by each call to EventLoop::wait_next_event.
+    enum class Result {
+        Success,  //!< At least one Rule was triggered.
+        Timeout,  //!< No rules were triggered before timeout.
+        Exit  //!< All rules have been canceled or were uninterested; make no further calls to EventLoop::wait_next_event.
+    };
+
   private:
     using CallbackT = std::function<void(void)>;  //!< Callback for ready Rule::fd
     using InterestT = std::function<bool(void)>;  //!< `true` return indicates Rule::fd should be polled.
 
+    static_assert(EPOLLIN == POLLIN and EPOLLOUT == POLLOUT, "Direction is used as both a poll and an epoll event");
+
     //! \brief Specifies a condition and callback that an EventLoop should handle.
     //! \details Created by calling EventLoop::add_rule() or EventLoop::add_cancelable_rule().
     class Rule {
       public:
-        FileDescriptor fd;    //!< FileDescriptor to monitor for activity.
-        Direction direction;  //!< Direction::In for reading from fd, Direction::Out for writing to fd.
-        CallbackT callback;   //!< A callback that reads or writes fd.
-        InterestT interest;   //!< A callback that returns `true` whenever fd should be polled.
-        CallbackT cancel;     //!< A callback that is called when the rule is cancelled (e.g. on hangup)
+        FileDescriptor fd;      //!< FileDescriptor to monitor for activity.
+        Direction direction;    //!< Direction::In for reading from fd, Direction::Out for writing to fd.
+        CallbackT callback;     //!< A callback that reads or writes fd.
+        InterestT interest;     //!< A callback that returns `true` whenever fd should be polled (or empty).
+        CallbackT cancel;       //!< A callback that is called when the rule is cancelled (e.g. on hangup)
+        bool interested{true};  //!< What Rule::interest returned when last asked (always `true` without one)
+        bool canceled{false};   //!< Set once the rule is canceled, until the EventLoop gets to erasing it
+        bool armed{false};      //!< Whether an IOUring poll for this rule is in flight (Backend::IOUring)
 
         //! Returns the number of times fd has been read or written, depending on the value of Rule::direction.
         //! \details This function is used internally by EventLoop; you will not need to call it
         unsigned int service_count() const;
+
+        //! Calls Rule::interest, if there is one, and remembers the answer in Rule::interested
+        bool check_interest() { return interested = (not interest or interest()); }
+
+        //! Whether Rule::fd can't be waited for any more: closed, or at EOF when reading
+        bool defunct() const { return fd.closed() or (direction == Direction::In and fd.eof()); }
+    };
+
+    using RuleIterator = std::list<Rule>::iterator;
+
+    //! The rules for one fd number, registered with epoll as one set of events
+    struct Registration {
+        std::vector<RuleIterator> rules{};  //!< The rules for this fd (usually one, or one per Direction)
+        uint32_t events{};                  //!< The events epoll was last asked to report
+        bool added{};                       //!< Whether the fd has been added to the epoll instance
     };
 
+    Backend _backend;          //!< How this EventLoop waits
     std::list<Rule> _rules{};  //!< All rules that have been added and not canceled.
 
+    //! \name State for Backend::Epoll
+    //!@{
+    std::optional<FileDescriptor> _epoll{};                  //!< The epoll instance
+    std::unordered_map<int, Registration> _registrations{};  //!< Registered fds, keyed by number
+    std::vector<RuleIterator> _watched{};                    //!< Rules with a Rule::interest to ask before waiting
+    std::vector<RuleIterator> _canceled{};                   //!< Canceled rules not yet erased
+    std::vector<RuleIterator> _unconditional{};              //!< Rules without a Rule::interest
+    std::vector<epoll_event> _ready{};                       //!< Events returned by epoll_wait
+    //!@}
+
+    //! The io_uring instance for Backend::IOUring, which also does the packet I/O of the batch_packets() fds
+    std::shared_ptr<IOUring> _io_uring{};
+
+    //! Cancel a rule (once); it is erased by the next sweep_canceled()
+    void cancel_rule(const RuleIterator rule);
+
+    //! Erase canceled rules, and stop watching fds that have no rules left
+    void sweep_canceled();
+
+    //! Ask epoll for the events that the rules for `fd_num` are interested in, if they've changed
+    void update_registration(const int fd_num, Registration &registration);
+
+    Result wait_with_poll(const int timeout_ms);
+    Result wait_with_epoll(const int timeout_ms);
+    Result wait_with_io_uring(const int timeout_ms);
+
   public:
-    //! Returned by each call to EventLoop::wait_next_event.
-    enum class Result {
-        Success,  //!< At least one Rule was triggered.
-        Timeout,  //!< No rules were triggered before timeout.
-        Exit  //!< All rules have been canceled or were uninterested; make no further calls to EventLoop::wait_next_event.
-    };
+    //! Construct an EventLoop that waits with the given Backend
+    explicit EventLoop(const Backend backend = Backend::Epoll);
+
+    //! Backend::IOUring if this build and the kernel support it, or else Backend::Epoll
+    static Backend fastest_backend();
+
+    //! With Backend::IOUring, receive `fd`'s packets (of up to `max_packet_size` bytes) in batches, and
+    //! queue its writes to go out with the next wait (see PacketBatcher); with any other Backend, do nothing
+    void batch_packets(const FileDescriptor &fd, const size_t max_packet_size);
 
     //! Add a rule whose callback will be called when `fd` is ready in the specified Direction.
     void add_rule(const FileDescriptor &fd,
                   const Direction direction,
                   const CallbackT &callback,
-                  const InterestT &interest = [] { return true; },
+                  const InterestT &interest = {},
                   const CallbackT &cancel = [] {});
 
-    //! Calls [poll(2)](\ref man2::poll) and then executes callback for each ready fd.
+    //! Calls [epoll_wait(2)](\ref man2::epoll_wait) or [poll(2)](\ref man2::poll) and then executes
+    //! callback for each ready fd.
     Result wait_next_event(const int timeout_ms);
 };
 
@@ -67,7 +140,19 @@ using Direction = EventLoop::Direction;
 //! When a Rule is installed using EventLoop::add_rule, it will be polled for the specified Rule::direction
 //! whenver the Rule::interest callback returns `true`, until Rule::fd is no longer readable
 //! (for Rule::direction == Direction::In) or writable (for Rule::direction == Direction::Out).
-//! Once this occurs, the Rule is canceled, i.e., the EventLoop deletes it.
+//! Once this occurs, the Rule is canceled, i.e., the EventLoop deletes it. A Rule added without an
+//! `interest` callback is always interested.
+//!
+//! With Backend::Epoll (the default), each fd is registered once, and the events it is registered for
+//! are only changed when the answer from an `interest` callback changes. Only the rules that have such a
+//! callback are visited before each wait, and only the ready ones after it, so a loop with many fds that
+//! are always of interest (like apps/bouncer.cc's) does work in proportion to the ready fds. Backend::Poll
+//! visits every Rule on each wait, as the EventLoop always used to.
+//!
+//! Backend::IOUring also visits every Rule, arming a one-shot poll for each interested one, and is meant
+//! for loops with a few fds that move many packets (like a TCPSpongeSocket's). Its gain is for the fds
+//! given to batch_packets(): their packets are received into pooled Buffers ahead of time, their writes
+//! are queued, and one [io_uring_enter(2)](\ref man2::io_uring_enter) per wait submits and collects it all.
 //!
 //! A Rule installed using EventLoop::add_cancelable_rule will be polled and canceled under the
 //! same conditions, with the additional condition that if Rule::callback returns `true`, the
@@ -73,6 +73,32 @@ string FileDescriptor::read(const size_t limit) {
     return ret;
 }
 
+//! \param[in] limit is the maximum number of bytes to read; fewer bytes may be returned
+//! \returns the bytes read, in storage that goes back to the pool when the last copy of the Buffer does
+//! \note With a PacketBatcher, this returns the next packet that it received, if there is one.
+Buffer FileDescriptor::read_packet(const size_t limit) {
+    Buffer ret;
+    if (packet_batcher() and packet_batcher()->take_packet(*this, ret, nullptr, nullptr)) {
+        register_read();
+        return ret;
+    }
+
+    ret = Buffer::allocate(limit);
+    char *const dest = ret.prepend(limit);
+
+    const ssize_t bytes_read = SystemCall("read", ::read(fd_num(), dest, limit));
+    if (limit > 0 && bytes_read == 0) {
+        _internal_fd->_eof = true;
+    }
+    if (bytes_read > static_cast<ssize_t>(limit)) {
+        throw runtime_error("read() read more than requested");
+    }
+    ret.remove_suffix(limit - bytes_read);
+
+    register_read();
+    return ret;
+}
+
 size_t FileDescriptor::write(BufferViewList buffer, const bool write_all) {
     size_t total_bytes_written = 0;
 
@@ -98,6 +124,16 @@ size_t FileDescriptor::write(BufferViewList buffer, const bool write_all) {
     return total_bytes_written;
 }
 
+//! \param[in] packet is the packet to write, which the PacketBatcher may keep until it has been written
+void FileDescriptor::write_packet(BufferList &&packet) {
+    if (packet_batcher()) {
+        packet_batcher()->queue_packet(*this, move(packet), nullptr, 0);
+        register_write();
+        return;
+    }
+    write(packet);
+}
+
 void FileDescriptor::set_blocking(const bool blocking_state) {
     int flags = SystemCall("fcntl", fcntl(fd_num(), F_GETFL));
     if (blocking_state) {
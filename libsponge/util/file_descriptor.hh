@@ -7,6 +7,26 @@
 #include <cstddef>
 #include <limits>
 #include <memory>
+#include <sys/socket.h>
+
+class FileDescriptor;
+
+//! \brief Does the packet reads and writes of a FileDescriptor for it, in batches (e.g. IOUring)
+class PacketBatcher {
+  public:
+    //! \brief Take the next packet that has been received for `fd`, and the address it came from
+    //! \param[out] source is where to store the address, if it isn't null (of at most `*source_len` bytes)
+    //! \returns `false` if there isn't one
+    virtual bool take_packet(const FileDescriptor &fd, Buffer &packet, sockaddr *source, socklen_t *source_len) = 0;
+
+    //! Queue `packet` to be written to `fd`, or sent to `destination` if it isn't null
+    virtual void queue_packet(const FileDescriptor &fd,
+                              BufferList &&packet,
+                              const sockaddr *destination,
+                              const socklen_t destination_len) = 0;
+
+    virtual ~PacketBatcher() = default;
+};
 
 //! A reference-counted handle to a file descriptor
 class FileDescriptor {
@@ -19,6 +39,7 @@ class FileDescriptor {
         bool _closed = false;       //!< Flag indicating whether FDWrapper::_fd has been closed
         unsigned _read_count = 0;   //!< The number of times FDWrapper::_fd has been read
         unsigned _write_count = 0;  //!< The numberof times FDWrapper::_fd has been written
+        PacketBatcher *_batcher{};  //!< Does the packet reads and writes instead, if set
 
         //! Construct from a file descriptor number returned by the kernel
         explicit FDWrapper(const int fd);
@@ -61,6 +82,12 @@ class FileDescriptor {
     //! Read up to `limit` bytes into `str` (caller can allocate storage)
     void read(std::string &str, const size_t limit = std::numeric_limits<size_t>::max());
 
+    //! Read up to `limit` bytes, in a single read, into a Buffer from the packet pool (e.g. one datagram)
+    Buffer read_packet(const size_t limit);
+
+    //! Write a packet (e.g. one datagram or frame) in a single write, which the PacketBatcher queues if set
+    void write_packet(BufferList &&packet);
+
     //! Write a string, possibly blocking until all is written
     size_t write(const char *str, const bool write_all = true) { return write(BufferViewList(str), write_all); }
 
@@ -79,6 +106,9 @@ class FileDescriptor {
     //! Set blocking(true) or non-blocking(false)
     void set_blocking(const bool blocking_state);
 
+    //! Hand packet reads and writes to `batcher` (or back to the kernel, if it's null)
+    void set_packet_batcher(PacketBatcher *batcher) { _internal_fd->_batcher = batcher; }
+
     //! \name FDWrapper accessors
     //!@{
 
@@ -96,6 +126,9 @@ class FileDescriptor {
 
     //! number of writes
     unsigned int write_count() const { return _internal_fd->_write_count; }
+
+    //! PacketBatcher doing the packet reads and writes, if any
+    PacketBatcher *packet_batcher() const { return _internal_fd->_batcher; }
     //!@}
 
     //! \name Copy/move constructor/assignment operators
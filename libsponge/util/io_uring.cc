@@ -0,0 +1,469 @@
+#include "io_uring.hh"
+
+#include "util.hh"
+
+#include <algorithm>
+#include <cerrno>
+#include <csignal>
+#include <cstring>
+#include <iostream>
+#include <stdexcept>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <utility>
+
+using namespace std;
+
+namespace {
+
+//! Entries in the submission queue (the completion queue gets twice as many)
+constexpr unsigned RING_ENTRIES = 256;
+
+//! Bytes of memory for a source's ring of Buffers (mmap()ed, since it must be page-aligned)
+constexpr size_t BUFFER_RING_SIZE = IOUring::RECEIVE_BUFFERS * sizeof(io_uring_buf);
+
+static_assert((IOUring::RECEIVE_BUFFERS & (IOUring::RECEIVE_BUFFERS - 1)) == 0,
+              "a ring of Buffers must have a power-of-two size");
+
+//! What an operation is, kept in the low bits of its `user_data` (the rest is a pointer to what it's for)
+enum Operation : uint64_t { POLL = 0, RECEIVE = 1, SEND = 2, CANCEL = 3 };
+constexpr uint64_t OPERATION_MASK = 3;
+
+uint64_t user_data(const void *ptr, const Operation operation) { return reinterpret_cast<uintptr_t>(ptr) | operation; }
+
+//! mmap() shared memory, throwing unix_error if it fails
+void *map(const size_t length, const int flags, const int fd_num, const off_t offset) {
+    void *const mapping = ::mmap(nullptr, length, PROT_READ | PROT_WRITE, flags, fd_num, offset);
+    if (mapping == MAP_FAILED) {
+        throw unix_error("mmap");
+    }
+    return mapping;
+}
+
+template <typename T>
+T *at(void *base, const size_t offset) {
+    return reinterpret_cast<T *>(static_cast<char *>(base) + offset);
+}
+
+}  // namespace
+
+//! \details Requires Linux 6.0 or later, for multishot `recvmsg` and rings of provided buffers.
+IOUring::IOUring() : _ring_fd([this] {
+    _params.flags = IORING_SETUP_CQSIZE;
+    _params.cq_entries = 2 * RING_ENTRIES;
+    return SystemCall("io_uring_setup", int(syscall(__NR_io_uring_setup, RING_ENTRIES, &_params)));
+}()) {
+    if (not(_params.features & IORING_FEAT_SINGLE_MMAP) or not(_params.features & IORING_FEAT_EXT_ARG)) {
+        throw unix_error("io_uring_setup", EOPNOTSUPP);
+    }
+
+    _rings_size = max(_params.sq_off.array + _params.sq_entries * sizeof(unsigned),
+                      _params.cq_off.cqes + _params.cq_entries * sizeof(io_uring_cqe));
+    _rings = map(_rings_size, MAP_SHARED | MAP_POPULATE, _ring_fd.fd_num(), IORING_OFF_SQ_RING);
+    _sqes_size = _params.sq_entries * sizeof(io_uring_sqe);
+    try {
+        _sqes = static_cast<io_uring_sqe *>(
+            map(_sqes_size, MAP_SHARED | MAP_POPULATE, _ring_fd.fd_num(), IORING_OFF_SQES));
+    } catch (...) {
+        ::munmap(_rings, _rings_size);
+        throw;
+    }
+
+    _sq_tail = at<unsigned>(_rings, _params.sq_off.tail);
+    _sq_array = at<unsigned>(_rings, _params.sq_off.array);
+    _sq_mask = *at<unsigned>(_rings, _params.sq_off.ring_mask);
+    _cq_head = at<unsigned>(_rings, _params.cq_off.head);
+    _cq_tail = at<unsigned>(_rings, _params.cq_off.tail);
+    _cq_mask = *at<unsigned>(_rings, _params.cq_off.ring_mask);
+    _cqes = at<io_uring_cqe>(_rings, _params.cq_off.cqes);
+    _sq_local_tail = *_sq_tail;
+}
+
+IOUring::~IOUring() {
+    for (auto &source : _sources) {
+        source->fd.set_packet_batcher(nullptr);
+    }
+
+    // the kernel may still write into the receive Buffers (and read the Sends) until everything has completed,
+    // so a completion that failed (e.g. a send) is only reported, and the draining goes on
+    _closing = true;
+    const auto report = [](const exception &e) { cerr << "Exception destructing IOUring: " << e.what() << endl; };
+    bool cancel_queued = false;
+    while (_in_flight > 0) {
+        try {
+            if (not cancel_queued) {
+                io_uring_sqe &cancel = next_sqe();
+                cancel.opcode = IORING_OP_ASYNC_CANCEL;
+                cancel.cancel_flags = IORING_ASYNC_CANCEL_ANY;
+                cancel.user_data = user_data(nullptr, CANCEL);
+                cancel_queued = true;
+            }
+        } catch (const unix_error &e) {
+            // (an overflowed completion queue is emptied below, and then the cancellation is queued again)
+            if (e.code().value() != EBUSY) {
+                report(e);
+                break;
+            }
+        }
+        try {
+            enter(1, -1);
+        } catch (const unix_error &e) {
+            if (e.code().value() != EINTR) {
+                report(e);
+                break;
+            }
+        }
+        for (bool reaped = false; not reaped;) {
+            try {
+                reap();
+                reaped = true;
+            } catch (const unix_error &e) {
+                if (e.code().value() != ECANCELED) {
+                    report(e);
+                }
+            } catch (const exception &e) {
+                report(e);
+            }
+        }
+    }
+
+    // if the kernel stopped taking entries, whatever it may still use is never freed
+    if (_in_flight > 0) {
+        for (auto &source : _sources) {
+            static_cast<void>(source.release());
+        }
+        for (auto &send : _sends) {
+            static_cast<void>(send.release());
+        }
+        _sources.clear();
+        _sends.clear();
+    }
+
+    for (auto &source : _sources) {
+        io_uring_buf_reg reg{};
+        reg.bgid = source->group;
+        ::syscall(__NR_io_uring_register, _ring_fd.fd_num(), IORING_UNREGISTER_PBUF_RING, &reg, 1);
+        ::munmap(source->ring, BUFFER_RING_SIZE);
+    }
+    ::munmap(_sqes, _sqes_size);
+    ::munmap(_rings, _rings_size);
+}
+
+//! \details With the submission queue full, it is handed to the kernel, which takes entries from it unless
+//! it's short of memory for a moment (EAGAIN, so it's handed over again) or its completion queue has
+//! overflowed (EBUSY, which only reaping completions can fix, so this throws unix_error).
+io_uring_sqe &IOUring::next_sqe() {
+    while (_unsubmitted == _params.sq_entries) {
+        if (enter(0, 0) == EBUSY) {
+            throw unix_error("io_uring_enter", EBUSY);
+        }
+    }
+    const unsigned index = _sq_local_tail & _sq_mask;
+    _sq_array[index] = index;
+    _sq_local_tail++;
+    _unsubmitted++;
+
+    io_uring_sqe &sqe = _sqes[index];
+    sqe = {};
+    return sqe;
+}
+
+//! \details A wait that times out, with nothing submitted, returns normally.
+int IOUring::enter(const unsigned wait_for, const int timeout_ms) {
+    __atomic_store_n(_sq_tail, _sq_local_tail, __ATOMIC_RELEASE);
+
+    __kernel_timespec timeout{timeout_ms / 1000, (timeout_ms % 1000) * 1'000'000LL};
+    io_uring_getevents_arg arg{};
+    arg.sigmask_sz = _NSIG / 8;
+    arg.ts = timeout_ms < 0 ? 0 : reinterpret_cast<uintptr_t>(&timeout);
+    const unsigned flags = IORING_ENTER_EXT_ARG | (wait_for > 0 ? IORING_ENTER_GETEVENTS : 0);
+
+    const long submitted =
+        ::syscall(__NR_io_uring_enter, _ring_fd.fd_num(), _unsubmitted, wait_for, flags, &arg, sizeof(arg));
+    if (submitted < 0) {
+        // (the completion queue is full, or the kernel is out of memory: nothing was submitted, so try again later)
+        if (errno == ETIME or errno == EBUSY or errno == EAGAIN) {
+            return errno;
+        }
+        throw unix_error("io_uring_enter");
+    }
+    _unsubmitted -= submitted;
+    return 0;
+}
+
+IOUring::PacketSource *IOUring::find_source(const FileDescriptor &fd) const {
+    for (const auto &source : _sources) {
+        if (source->fd.fd_num() == fd.fd_num()) {
+            return source.get();
+        }
+    }
+    return nullptr;
+}
+
+void IOUring::give_buffer(PacketSource &source, const uint16_t slot) {
+    Buffer buffer = Buffer::allocate(source.slot_size);
+    char *const bytes = buffer.prepend(source.slot_size);
+    source.slots[slot] = move(buffer);
+
+    // (not `source.ring->bufs`, which the uapi header declares in a way that starts 8 bytes in, when compiled as C++)
+    io_uring_buf &entry = reinterpret_cast<io_uring_buf *>(source.ring)[source.ring_tail & (RECEIVE_BUFFERS - 1)];
+    entry.addr = reinterpret_cast<uintptr_t>(bytes);
+    entry.len = source.slot_size;
+    entry.bid = slot;
+    source.ring_tail++;
+    __atomic_store_n(&source.ring->tail, source.ring_tail, __ATOMIC_RELEASE);
+    source.buffers_with_kernel++;
+}
+
+//! \details A socket gets one multishot `recvmsg`, which receives datagrams until the kernel runs
+//! out of Buffers for it; anything else gets up to READS_IN_FLIGHT `read`s.
+void IOUring::arm_receives(PacketSource &source) {
+    if (_closing or source.fd.closed()) {
+        return;
+    }
+    const unsigned wanted = source.is_socket ? 1 : READS_IN_FLIGHT;
+    while (source.receives_in_flight < min(wanted, source.buffers_with_kernel)) {
+        io_uring_sqe &sqe = next_sqe();
+        sqe.fd = source.fd.fd_num();
+        sqe.flags = IOSQE_BUFFER_SELECT;
+        sqe.buf_group = source.group;
+        sqe.user_data = user_data(&source, RECEIVE);
+        if (source.is_socket) {
+            sqe.opcode = IORING_OP_RECVMSG;
+            sqe.ioprio = IORING_RECV_MULTISHOT;
+            sqe.addr = reinterpret_cast<uintptr_t>(&source.message);
+        } else {
+            sqe.opcode = IORING_OP_READ;
+            sqe.len = source.slot_size;
+            sqe.off = ~uint64_t(0);
+        }
+        source.receives_in_flight++;
+        _in_flight++;
+    }
+}
+
+//! \details Datagrams that didn't fit in a Buffer are dropped, as are empty reads.
+void IOUring::complete_receive(PacketSource &source, const io_uring_cqe &cqe) {
+    if (not(cqe.flags & IORING_CQE_F_MORE)) {
+        source.receives_in_flight--;
+        _in_flight--;
+    }
+    if (not(cqe.flags & IORING_CQE_F_BUFFER)) {
+        // (out of Buffers, which arm_receives() deals with once one is taken, or canceled)
+        if (cqe.res < 0 and cqe.res != -ENOBUFS and cqe.res != -ECANCELED) {
+            throw unix_error(source.is_socket ? "recvmsg" : "read", -cqe.res);
+        }
+        return;
+    }
+
+    const uint16_t slot = cqe.flags >> IORING_CQE_BUFFER_SHIFT;
+    source.buffers_with_kernel--;
+    Buffer payload = move(source.slots[slot]);
+    sockaddr_storage address{};
+    socklen_t address_len = 0;
+    size_t length = cqe.res;
+    if (source.is_socket) {
+        io_uring_recvmsg_out out;
+        memcpy(&out, payload.str().data(), sizeof(out));
+        if (out.flags & MSG_TRUNC) {
+            give_buffer(source, slot);
+            return;
+        }
+        const size_t name_room = source.message.msg_namelen;
+        address_len = min<socklen_t>(out.namelen, name_room);
+        memcpy(&address, payload.str().data() + sizeof(out), address_len);
+        payload.remove_prefix(sizeof(out) + name_room + source.message.msg_controllen);
+        length = out.payloadlen;
+    } else if (length == 0) {
+        give_buffer(source, slot);
+        return;
+    }
+    payload.remove_suffix(payload.size() - length);
+
+    Packet &packet = source.received[(source.received_head + source.received_count) % RECEIVE_BUFFERS];
+    packet = {move(payload), address, address_len, slot};
+    source.received_count++;
+}
+
+void IOUring::complete_send(Send &send, const io_uring_cqe &cqe) {
+    _in_flight--;
+    const bool datagram = send.message.msg_name;
+    const size_t size = send.size;
+    send.packet = BufferList{};
+    _free_sends.push_back(&send);
+
+    if (cqe.res < 0) {
+        throw unix_error(datagram ? "sendmsg" : "writev", -cqe.res);
+    }
+    if (size_t(cqe.res) != size) {
+        throw runtime_error("IOUring: packet was only written in part");
+    }
+}
+
+//! \details The `fd` is duplicated, so its FDWrapper (which holds the PacketBatcher) stays alive as
+//! long as the IOUring does. Packets that are longer than `max_packet_size` bytes are dropped.
+void IOUring::add_packet_source(const FileDescriptor &fd, const size_t max_packet_size) {
+    if (find_source(fd)) {
+        throw runtime_error("IOUring: fd is already a packet source");
+    }
+    if (_sources.size() > UINT16_MAX) {
+        throw runtime_error("IOUring: too many packet sources");
+    }
+
+    int type = 0;
+    socklen_t type_len = sizeof(type);
+    const bool is_socket = ::getsockopt(fd.fd_num(), SOL_SOCKET, SO_TYPE, &type, &type_len) == 0;
+
+    // a socket's Buffers also hold an io_uring_recvmsg_out header, and the source address
+    auto source = make_unique<PacketSource>(PacketSource{
+        fd.duplicate(),
+        is_socket,
+        max_packet_size + (is_socket ? sizeof(io_uring_recvmsg_out) + sizeof(sockaddr_storage) : 0),
+        uint16_t(_sources.size()),
+        static_cast<io_uring_buf_ring *>(map(BUFFER_RING_SIZE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0)),
+        0,
+        vector<Buffer>(RECEIVE_BUFFERS),
+        vector<Packet>(RECEIVE_BUFFERS),
+        0,
+        0,
+        {},
+        0,
+        0});
+    source->message.msg_namelen = sizeof(sockaddr_storage);
+
+    io_uring_buf_reg reg{};
+    reg.ring_addr = reinterpret_cast<uintptr_t>(source->ring);
+    reg.ring_entries = RECEIVE_BUFFERS;
+    reg.bgid = source->group;
+    try {
+        SystemCall("io_uring_register",
+                   int(::syscall(__NR_io_uring_register, _ring_fd.fd_num(), IORING_REGISTER_PBUF_RING, &reg, 1)));
+    } catch (...) {
+        ::munmap(source->ring, BUFFER_RING_SIZE);
+        throw;
+    }
+
+    for (uint16_t slot = 0; slot < RECEIVE_BUFFERS; slot++) {
+        give_buffer(*source, slot);
+    }
+    source->fd.set_packet_batcher(this);
+    _sources.push_back(move(source));
+}
+
+bool IOUring::has_packet(const FileDescriptor &fd) const {
+    const PacketSource *const source = find_source(fd);
+    return source and source->received_count > 0;
+}
+
+void IOUring::arm_poll(const int fd_num, const short events, void *token) {
+    io_uring_sqe &sqe = next_sqe();
+    sqe.opcode = IORING_OP_POLL_ADD;
+    sqe.fd = fd_num;
+    sqe.poll32_events = static_cast<unsigned short>(events);
+    sqe.user_data = user_data(token, POLL);
+    _in_flight++;
+}
+
+void IOUring::cancel_poll(void *token) {
+    io_uring_sqe &sqe = next_sqe();
+    sqe.opcode = IORING_OP_ASYNC_CANCEL;
+    sqe.addr = user_data(token, POLL);
+    sqe.user_data = user_data(nullptr, CANCEL);
+}
+
+size_t IOUring::wait(const int timeout_ms) {
+    _polls.clear();
+    for (const auto &source : _sources) {
+        arm_receives(*source);
+    }
+
+    // only enter the kernel if there's something to submit, or nothing has completed yet and there's time to wait
+    const bool completed = *_cq_head != __atomic_load_n(_cq_tail, __ATOMIC_ACQUIRE);
+    if (_unsubmitted > 0 or (not completed and timeout_ms != 0)) {
+        enter(completed ? 0 : 1, timeout_ms);
+    }
+    return reap();
+}
+
+//! \details A completion that failed throws, leaving any after it to be reaped next time.
+size_t IOUring::reap() {
+    size_t count = 0;
+    unsigned head = *_cq_head;
+    while (head != __atomic_load_n(_cq_tail, __ATOMIC_ACQUIRE)) {
+        const io_uring_cqe cqe = _cqes[head & _cq_mask];
+        __atomic_store_n(_cq_head, ++head, __ATOMIC_RELEASE);
+        count++;
+
+        void *const ptr = reinterpret_cast<void *>(cqe.user_data & ~OPERATION_MASK);
+        switch (cqe.user_data & OPERATION_MASK) {
+            case POLL:
+                _in_flight--;
+                _polls.push_back({ptr, cqe.res});
+                break;
+            case RECEIVE:
+                complete_receive(*static_cast<PacketSource *>(ptr), cqe);
+                break;
+            case SEND:
+                complete_send(*static_cast<Send *>(ptr), cqe);
+                break;
+            default:  // a cancellation, which is done whether or not it found anything
+                break;
+        }
+    }
+    return count;
+}
+
+bool IOUring::take_packet(const FileDescriptor &fd, Buffer &packet, sockaddr *source, socklen_t *source_len) {
+    PacketSource *const packet_source = find_source(fd);
+    if (not packet_source or packet_source->received_count == 0) {
+        return false;
+    }
+
+    Packet &oldest = packet_source->received[packet_source->received_head];
+    packet = move(oldest.payload);
+    if (source) {
+        memcpy(source, &oldest.source, min(*source_len, oldest.source_len));
+        *source_len = oldest.source_len;
+    }
+    packet_source->received_head = (packet_source->received_head + 1) % RECEIVE_BUFFERS;
+    packet_source->received_count--;
+    give_buffer(*packet_source, oldest.slot);
+    return true;
+}
+
+//! \details The packet goes out with the next wait(), along with any others queued before it.
+void IOUring::queue_packet(const FileDescriptor &fd,
+                           BufferList &&packet,
+                           const sockaddr *destination,
+                           const socklen_t destination_len) {
+    if (_free_sends.empty()) {
+        _sends.push_back(make_unique<Send>());
+        _free_sends.push_back(_sends.back().get());
+    }
+    io_uring_sqe &sqe = next_sqe();
+    Send &send = *_free_sends.back();
+    _free_sends.pop_back();
+
+    send.packet = move(packet);
+    send.iovecs = BufferViewList(send.packet).as_iovecs();
+    send.size = send.packet.size();
+    send.message = {};
+    sqe.fd = fd.fd_num();
+    sqe.user_data = user_data(&send, SEND);
+    if (destination) {
+        memcpy(&send.destination, destination, destination_len);
+        send.message.msg_name = &send.destination;
+        send.message.msg_namelen = destination_len;
+        send.message.msg_iov = send.iovecs.data();
+        send.message.msg_iovlen = send.iovecs.size();
+        sqe.opcode = IORING_OP_SENDMSG;
+        sqe.addr = reinterpret_cast<uintptr_t>(&send.message);
+    } else {
+        sqe.opcode = IORING_OP_WRITEV;
+        sqe.addr = reinterpret_cast<uintptr_t>(send.iovecs.data());
+        sqe.len = send.iovecs.size();
+        sqe.off = ~uint64_t(0);
+    }
+    _in_flight++;
+}
@@ -0,0 +1,168 @@
+#ifndef SPONGE_LIBSPONGE_IO_URING_HH
+#define SPONGE_LIBSPONGE_IO_URING_HH
+
+#include "buffer.hh"
+#include "file_descriptor.hh"
+
+#include <cstddef>
+#include <cstdint>
+#include <linux/io_uring.h>
+#include <memory>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <vector>
+
+//! \brief An [io_uring](\ref man7::io_uring) instance that receives and sends packets in batches
+//! \details Each packet source (a UDP socket, or a TUN or TAP device) gets a ring of RECEIVE_BUFFERS
+//! Buffers from the packet pool, which the kernel fills with packets as they arrive: one multishot
+//! `recvmsg` per socket, or a few `read`s in flight per device. The IOUring becomes the source's
+//! PacketBatcher, so reads of it return those packets, and writes to it are queued. One wait() submits
+//! the queued writes and any readiness polls, and collects every completion, in one system call.
+//!
+//! A received packet is the Buffer that the kernel wrote it into; the ring gets a new Buffer once the
+//! packet is taken. So at most RECEIVE_BUFFERS packets wait here, and the rest wait in the kernel.
+class IOUring : public PacketBatcher {
+  public:
+    //! Number of receive Buffers that each packet source has, with the kernel or waiting to be taken
+    static constexpr unsigned RECEIVE_BUFFERS = 64;
+
+    //! Number of `read`s kept in flight for a packet source that isn't a socket
+    static constexpr unsigned READS_IN_FLIGHT = 8;
+
+    //! A readiness poll that has completed
+    struct PollResult {
+        void *token;  //!< What arm_poll() was given
+        int result;   //!< The events that are ready, or a negative errno (e.g. `-ECANCELED`)
+    };
+
+  private:
+    //! A packet that has been received, and the Buffer slot to refill when it's taken
+    struct Packet {
+        Buffer payload{};
+        sockaddr_storage source{};
+        socklen_t source_len{};
+        uint16_t slot{};
+    };
+
+    //! A UDP socket or device whose packets are received into a ring of Buffers
+    struct PacketSource {
+        FileDescriptor fd;              //!< The socket or device (a duplicate, so it stays open)
+        bool is_socket;                 //!< Whether to use `recvmsg`, which gives the source address, or `read`
+        size_t slot_size;               //!< Size of each receive Buffer
+        uint16_t group;                 //!< The buffer group ID of the ring
+        io_uring_buf_ring *ring;        //!< The ring through which the kernel takes Buffers to fill
+        uint16_t ring_tail;             //!< Where the next Buffer goes in the ring
+        std::vector<Buffer> slots;      //!< The receive Buffers, by ID; empty while a packet is waiting
+        std::vector<Packet> received;   //!< Packets waiting to be taken, in a ring of RECEIVE_BUFFERS
+        unsigned received_head;         //!< Where the oldest waiting packet is in `received`
+        unsigned received_count;        //!< Number of packets waiting to be taken
+        msghdr message;                 //!< How much room `recvmsg` leaves for the source address
+        unsigned receives_in_flight;    //!< Receives that will complete (a multishot `recvmsg` counts once)
+        unsigned buffers_with_kernel;   //!< Buffers in the ring that the kernel hasn't filled yet
+    };
+
+    //! A packet being written, which is kept (along with where it's going) until the write completes
+    struct Send {
+        BufferList packet{};
+        SmallVector<iovec, BufferViewList::INLINE_CAPACITY> iovecs{};
+        msghdr message{};
+        sockaddr_storage destination{};
+        size_t size{};
+    };
+
+    io_uring_params _params{};  //!< What the kernel set up (e.g. where the rings are)
+    FileDescriptor _ring_fd;    //!< The io_uring instance
+
+    //! \name The rings shared with the kernel
+    //!@{
+    void *_rings{};         //!< The submission and completion rings, in one mapping
+    size_t _rings_size{};   //!< Size of `_rings`
+    io_uring_sqe *_sqes{};  //!< The submission queue entries
+    size_t _sqes_size{};    //!< Size of `_sqes`
+    unsigned *_sq_tail{};
+    unsigned *_sq_array{};
+    unsigned _sq_mask{};
+    unsigned *_cq_head{};
+    unsigned *_cq_tail{};
+    unsigned _cq_mask{};
+    io_uring_cqe *_cqes{};
+    //!@}
+
+    unsigned _sq_local_tail{};  //!< Where the next submission queue entry goes
+    unsigned _unsubmitted{};    //!< Entries that haven't been handed to the kernel yet
+    size_t _in_flight{};        //!< Operations that will still complete (e.g. multishot receives, sends)
+    bool _closing{};            //!< Whether everything is being canceled, so receives mustn't be armed again
+
+    std::vector<std::unique_ptr<PacketSource>> _sources{};
+    std::vector<PollResult> _polls{};             //!< The polls that the last wait() collected
+    std::vector<std::unique_ptr<Send>> _sends{};  //!< Every Send, in flight or not
+    std::vector<Send *> _free_sends{};            //!< The Sends that aren't in flight
+
+    //! The next free submission queue entry (submitting what's queued if there isn't one)
+    io_uring_sqe &next_sqe();
+
+    //! Hand the queued entries to the kernel, and wait for `wait_for` completions
+    //! \returns 0, or the error (ETIME, EBUSY or EAGAIN) for which the kernel took nothing
+    int enter(const unsigned wait_for, const int timeout_ms);
+
+    //! Collect the completions there are (the readiness polls among them into `_polls`)
+    size_t reap();
+
+    PacketSource *find_source(const FileDescriptor &fd) const;
+
+    //! Give a new Buffer to the kernel to fill, in the source's slot `slot`
+    void give_buffer(PacketSource &source, const uint16_t slot);
+
+    //! Queue more receives for a source, if it has Buffers for them
+    void arm_receives(PacketSource &source);
+
+    void complete_receive(PacketSource &source, const io_uring_cqe &cqe);
+    void complete_send(Send &send, const io_uring_cqe &cqe);
+
+  public:
+    //! Set up an io_uring instance, or throw unix_error if the kernel won't (e.g. too old, or disallowed)
+    IOUring();
+
+    //! Cancel everything in flight, and wait for it to finish before freeing the Buffers it uses
+    ~IOUring() override;
+
+    //! \name An IOUring can't be copied or moved, since the kernel has pointers into it
+    //!@{
+    IOUring(const IOUring &other) = delete;
+    IOUring &operator=(const IOUring &other) = delete;
+    IOUring(IOUring &&other) = delete;
+    IOUring &operator=(IOUring &&other) = delete;
+    //!@}
+
+    //! Receive packets of up to `max_packet_size` bytes from `fd`, and queue writes to it
+    void add_packet_source(const FileDescriptor &fd, const size_t max_packet_size);
+
+    //! Whether a packet received for `fd` is waiting to be taken
+    bool has_packet(const FileDescriptor &fd) const;
+
+    //! Poll `fd_num` once for `events`; wait() reports the result along with `token`
+    void arm_poll(const int fd_num, const short events, void *token);
+
+    //! Cancel a poll armed with `token` (which is still reported, usually with `-ECANCELED`)
+    void cancel_poll(void *token);
+
+    //! \brief Submit everything queued, wait up to `timeout_ms` (-1 for no limit) for a completion,
+    //! and collect all that there are
+    //! \returns the number of completions (the readiness polls among them are in polls())
+    //! \note Throws unix_error with EINTR if a signal arrived while waiting.
+    size_t wait(const int timeout_ms);
+
+    //! The readiness polls that the last wait() collected
+    const std::vector<PollResult> &polls() const { return _polls; }
+
+    //! \name PacketBatcher
+    //!@{
+    bool take_packet(const FileDescriptor &fd, Buffer &packet, sockaddr *source, socklen_t *source_len) override;
+    void queue_packet(const FileDescriptor &fd,
+                      BufferList &&packet,
+                      const sockaddr *destination,
+                      const socklen_t destination_len) override;
+    //!@}
+};
+
+#endif  // SPONGE_LIBSPONGE_IO_URING_HH
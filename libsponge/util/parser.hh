@@ -5,7 +5,10 @@
 
 #include <cstdint>
 #include <cstdlib>
+#include <cstring>
+#include <endian.h>
 #include <string>
+#include <string_view>
 #include <utility>
 
 //! The result of parsing or unparsing an IP datagram, TCP segment, Ethernet frame, or ARP message
@@ -24,20 +27,25 @@ std::string as_string(const ParseResult r);
 
 class NetParser {
   private:
-    Buffer _buffer;
+    Buffer _buffer;                             //!< Everything being parsed, which keeps the bytes alive
+    std::string_view _remaining;                //!< The bytes of `_buffer` not yet parsed
     ParseResult _error = ParseResult::NoError;  //!< Result of parsing so far
 
     //! Check that there is sufficient data to parse the next token
-    void _check_size(const size_t size);
-
-    //! Generic integer parsing method (used by u32, u16, u8)
-    template <typename T>
-    T _parse_int();
+    void _check_size(const size_t size) {
+        if (size > _remaining.size()) {
+            set_error(ParseResult::PacketTooShort);
+        }
+    }
 
   public:
-    NetParser(Buffer buffer) : _buffer(buffer) {}
+    NetParser(Buffer buffer) : _buffer(buffer), _remaining(_buffer.str()) {}
+
+    //! \returns the bytes not yet parsed, sharing the storage of the Buffer being parsed
+    Buffer buffer() const { return _buffer.substr(_buffer.size() - _remaining.size()); }
 
-    Buffer buffer() const { return _buffer; }
+    //! \returns the number of bytes not yet parsed
+    size_t size() const { return _remaining.size(); }
 
     //! Get the current value stored in BaseParser::_error
     ParseResult get_error() const { return _error; }
@@ -49,17 +57,56 @@ class NetParser {
     //! Returns `true` if there has been an error
     bool error() const { return get_error() != ParseResult::NoError; }
 
+    //! \brief Consume the next `n` bytes, checking just once that they are all there
+    //! \returns the bytes, to decode with the load functions below, or `nullptr` if fewer than `n` remain
+    const char *take(const size_t n) {
+        _check_size(n);
+        if (error()) {
+            return nullptr;
+        }
+        const char *ret = _remaining.data();
+        _remaining.remove_prefix(n);
+        return ret;
+    }
+
     //! Parse a 32-bit integer in network byte order from the data stream
-    uint32_t u32();
+    uint32_t u32() {
+        const char *data = take(sizeof(uint32_t));
+        return data ? load_u32(data) : 0;
+    }
 
     //! Parse a 16-bit integer in network byte order from the data stream
-    uint16_t u16();
+    uint16_t u16() {
+        const char *data = take(sizeof(uint16_t));
+        return data ? load_u16(data) : 0;
+    }
 
     //! Parse an 8-bit integer in network byte order from the data stream
-    uint8_t u8();
+    uint8_t u8() {
+        const char *data = take(sizeof(uint8_t));
+        return data ? load_u8(data) : 0;
+    }
 
     //! Remove n bytes from the buffer
-    void remove_prefix(const size_t n);
+    void remove_prefix(const size_t n) { take(n); }
+
+    //! \name Unaligned loads of integers in network byte order
+    //! \note These don't check bounds: use them on bytes returned by take().
+    //!@{
+    static uint32_t load_u32(const char *data) {
+        uint32_t val;
+        memcpy(&val, data, sizeof(val));
+        return be32toh(val);
+    }
+
+    static uint16_t load_u16(const char *data) {
+        uint16_t val;
+        memcpy(&val, data, sizeof(val));
+        return be16toh(val);
+    }
+
+    static uint8_t load_u8(const char *data) { return *data; }
+    //!@}
 };
 
 struct NetUnparser {
@@ -74,6 +121,22 @@ struct NetUnparser {
 
     //! Write an 8-bit integer into the data stream in network byte order
     static void u8(std::string &s, const uint8_t val);
+
+    //! \name Unaligned stores of integers in network byte order
+    //! \note These don't check bounds: `dest` must have room for the integer.
+    //!@{
+    static void store_u32(char *dest, const uint32_t val) {
+        const uint32_t be_val = htobe32(val);
+        memcpy(dest, &be_val, sizeof(be_val));
+    }
+
+    static void store_u16(char *dest, const uint16_t val) {
+        const uint16_t be_val = htobe16(val);
+        memcpy(dest, &be_val, sizeof(be_val));
+    }
+
+    static void store_u8(char *dest, const uint8_t val) { *dest = val; }
+    //!@}
 };
 
 #endif  // SPONGE_LIBSPONGE_PARSER_HH
@@ -0,0 +1,178 @@
+#ifndef SPONGE_LIBSPONGE_SMALL_VECTOR_HH
+#define SPONGE_LIBSPONGE_SMALL_VECTOR_HH
+
+#include <algorithm>
+#include <cstddef>
+#include <new>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+//! \brief A vector that keeps up to `N` elements inside itself, and only allocates when it holds more
+//! \details Used for the handful of pieces of a packet (BufferList, BufferViewList, iovecs), which a
+//! std::deque or std::vector would allocate for even when there are only one or two. Only what those
+//! need is provided: appending at the back, and erasing from the front.
+template <typename T, size_t N>
+class SmallVector {
+  private:
+    std::aligned_storage_t<sizeof(T), alignof(T)> _inline[N];  //!< Storage for the first `N` elements
+    T *_data;                                                  //!< `_inline`, or the heap once that's full
+    size_t _size;
+    size_t _capacity;
+
+    bool is_inline() const { return _data == reinterpret_cast<const T *>(_inline); }
+
+    static T *allocate(const size_t capacity) { return static_cast<T *>(::operator new(capacity * sizeof(T))); }
+
+    //! Move the elements to `data`, heap storage for `capacity` of them
+    void move_to(T *data, const size_t capacity) {
+        for (size_t i = 0; i < _size; i++) {
+            new (data + i) T(std::move(_data[i]));
+            _data[i].~T();
+        }
+        if (not is_inline()) {
+            ::operator delete(_data);
+        }
+        _data = data;
+        _capacity = capacity;
+    }
+
+    //! Take the elements of `other`: its heap storage if it has any, or else moves of its elements
+    void take(SmallVector &&other) noexcept {
+        if (other.is_inline()) {
+            for (size_t i = 0; i < other._size; i++) {
+                new (_data + i) T(std::move(other._data[i]));
+            }
+            _size = other._size;
+            other.clear();
+        } else {
+            _data = std::exchange(other._data, reinterpret_cast<T *>(other._inline));
+            _size = std::exchange(other._size, 0);
+            _capacity = std::exchange(other._capacity, N);
+        }
+    }
+
+    //! Release any heap storage (the elements must have been destroyed)
+    void free_storage() {
+        if (not is_inline()) {
+            ::operator delete(_data);
+        }
+        _data = reinterpret_cast<T *>(_inline);
+        _capacity = N;
+    }
+
+  public:
+    static_assert(N > 0, "SmallVector needs room for at least one element inside itself");
+    static_assert(std::is_nothrow_move_constructible_v<T>, "SmallVector moves its elements without a fallback");
+
+    //! \name Constructors, destructor and assignment
+    //!@{
+    SmallVector() : _data(reinterpret_cast<T *>(_inline)), _size(0), _capacity(N) {}
+
+    SmallVector(const SmallVector &other) : SmallVector() {
+        reserve(other._size);
+        for (const T &element : other) {
+            push_back(element);
+        }
+    }
+
+    SmallVector(SmallVector &&other) noexcept : SmallVector() { take(std::move(other)); }
+
+    SmallVector &operator=(const SmallVector &other) {
+        if (this != &other) {
+            clear();
+            reserve(other._size);
+            for (const T &element : other) {
+                push_back(element);
+            }
+        }
+        return *this;
+    }
+
+    SmallVector &operator=(SmallVector &&other) noexcept {
+        if (this != &other) {
+            clear();
+            free_storage();
+            take(std::move(other));
+        }
+        return *this;
+    }
+
+    ~SmallVector() {
+        clear();
+        free_storage();
+    }
+    //!@}
+
+    //! \name Element access
+    //!@{
+    T *data() { return _data; }
+    const T *data() const { return _data; }
+    T *begin() { return _data; }
+    const T *begin() const { return _data; }
+    T *end() { return _data + _size; }
+    const T *end() const { return _data + _size; }
+    T &operator[](const size_t i) { return _data[i]; }
+    const T &operator[](const size_t i) const { return _data[i]; }
+    T &front() { return _data[0]; }
+    const T &front() const { return _data[0]; }
+    T &back() { return _data[_size - 1]; }
+    const T &back() const { return _data[_size - 1]; }
+    //!@}
+
+    size_t size() const { return _size; }
+    bool empty() const { return _size == 0; }
+
+    //! Make room for `capacity` elements in all
+    void reserve(const size_t capacity) {
+        if (capacity > _capacity) {
+            move_to(allocate(capacity), capacity);
+        }
+    }
+
+    //! Append an element
+    //! \note The element is constructed before any others move, so `args` may refer to one of them.
+    template <typename... Args>
+    T &emplace_back(Args &&... args) {
+        T *element;
+        if (_size < _capacity) {
+            element = new (_data + _size) T(std::forward<Args>(args)...);
+        } else {
+            T *const data = allocate(2 * _capacity);
+            try {
+                element = new (data + _size) T(std::forward<Args>(args)...);
+            } catch (...) {
+                ::operator delete(data);
+                throw;
+            }
+            move_to(data, 2 * _capacity);
+        }
+        _size++;
+        return *element;
+    }
+
+    void push_back(const T &element) { emplace_back(element); }
+    void push_back(T &&element) { emplace_back(std::move(element)); }
+
+    //! Erase the first `n` elements, moving the rest down
+    void erase_front(const size_t n) {
+        if (n > _size) {
+            throw std::out_of_range("SmallVector::erase_front");
+        }
+        std::move(_data + n, _data + _size, _data);
+        for (size_t i = _size - n; i < _size; i++) {
+            _data[i].~T();
+        }
+        _size -= n;
+    }
+
+    //! Destroy all the elements (keeping any heap storage)
+    void clear() {
+        for (size_t i = 0; i < _size; i++) {
+            _data[i].~T();
+        }
+        _size = 0;
+    }
+};
+
+#endif  // SPONGE_LIBSPONGE_SMALL_VECTOR_HH
@@ -85,29 +85,38 @@ void Socket::shutdown(const int how) {
 }
 
 //! \note If `mtu` is too small to hold the received datagram, this method throws a std::runtime_error
+//! \note With a PacketBatcher, this returns the next datagram that it received, if there is one.
 void UDPSocket::recv(received_datagram &datagram, const size_t mtu) {
     // receive source address and payload
     Address::Raw datagram_source_address;
-    datagram.payload.resize(mtu);
+    if (packet_batcher()) {
+        socklen_t source_len = sizeof(datagram_source_address);
+        if (packet_batcher()->take_packet(*this, datagram.payload, datagram_source_address, &source_len)) {
+            register_read();
+            datagram.source_address = {datagram_source_address, source_len};
+            return;
+        }
+    }
+    Buffer payload = Buffer::allocate(mtu);
+    char *const dest = payload.prepend(mtu);
 
     socklen_t fromlen = sizeof(datagram_source_address);
 
-    const ssize_t recv_len = SystemCall(
-        "recvfrom",
-        ::recvfrom(
-            fd_num(), datagram.payload.data(), datagram.payload.size(), MSG_TRUNC, datagram_source_address, &fromlen));
+    const ssize_t recv_len =
+        SystemCall("recvfrom", ::recvfrom(fd_num(), dest, mtu, MSG_TRUNC, datagram_source_address, &fromlen));
 
     if (recv_len > ssize_t(mtu)) {
         throw runtime_error("recvfrom (oversized datagram)");
     }
 
     register_read();
+    payload.remove_suffix(mtu - recv_len);
     datagram.source_address = {datagram_source_address, fromlen};
-    datagram.payload.resize(recv_len);
+    datagram.payload = move(payload);
 }
 
 UDPSocket::received_datagram UDPSocket::recv(const size_t mtu) {
-    received_datagram ret{{nullptr, 0}, ""};
+    received_datagram ret{{nullptr, 0}, {}};
     recv(ret, mtu);
     return ret;
 }
@@ -136,6 +145,15 @@ void UDPSocket::sendto(const Address &destination, const BufferViewList &payload
     register_write();
 }
 
+void UDPSocket::send_packet(const Address &destination, BufferList &&payload) {
+    if (not packet_batcher()) {
+        sendto(destination, payload);
+        return;
+    }
+    packet_batcher()->queue_packet(*this, move(payload), destination, destination.size());
+    register_write();
+}
+
 void UDPSocket::send(const BufferViewList &payload) {
     sendmsg_helper(fd_num(), nullptr, 0, payload);
     register_write();
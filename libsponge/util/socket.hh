@@ -61,18 +61,21 @@ class UDPSocket : public Socket {
     //! Returned by UDPSocket::recv; carries received data and information about the sender
     struct received_datagram {
         Address source_address;  //!< Address from which this datagram was received
-        std::string payload;     //!< UDP datagram payload
+        Buffer payload;          //!< UDP datagram payload, in storage from the packet pool
     };
 
     //! Receive a datagram and the Address of its sender
     received_datagram recv(const size_t mtu = 65536);
 
-    //! Receive a datagram and the Address of its sender (caller can allocate storage)
+    //! Receive a datagram and the Address of its sender into an existing received_datagram
     void recv(received_datagram &datagram, const size_t mtu = 65536);
 
     //! Send a datagram to specified Address
     void sendto(const Address &destination, const BufferViewList &payload);
 
+    //! Send a datagram to specified Address, which the PacketBatcher (if any) queues along with `payload`
+    void send_packet(const Address &destination, BufferList &&payload);
+
     //! Send datagram to the socket's connected address (must call connect() first)
     void send(const BufferViewList &payload);
 };
@@ -1,10 +1,12 @@
 #include "tun.hh"
 
+#include "socket.hh"
 #include "util.hh"
 
 #include <cstring>
 #include <fcntl.h>
 #include <linux/if.h>
+#include <linux/if_ether.h>
 #include <linux/if_tun.h>
 #include <sys/ioctl.h>
 
@@ -22,7 +24,7 @@ using namespace std;
 //! as root before calling this function.
 
 TunTapFD::TunTapFD(const string &devname, const bool is_tun)
-    : FileDescriptor(SystemCall("open", open(CLONEDEV, O_RDWR))) {
+    : FileDescriptor(SystemCall("open", open(CLONEDEV, O_RDWR))), _max_packet_size() {
     struct ifreq tun_req {};
 
     tun_req.ifr_flags = (is_tun ? IFF_TUN : IFF_TAP) | IFF_NO_PI;  // tun device with no packetinfo
@@ -33,4 +35,16 @@ TunTapFD::TunTapFD(const string &devname, const bool is_tun)
     tun_req.ifr_name[IFNAMSIZ - 1] = '\0';
 
     SystemCall("ioctl", ioctl(fd_num(), TUNSETIFF, static_cast<void *>(&tun_req)));
+
+    _max_packet_size = mtu() + (is_tun ? 0 : ETH_HLEN);
+}
+
+size_t TunTapFD::mtu() const {
+    struct ifreq req {};
+    SystemCall("ioctl", ioctl(fd_num(), TUNGETIFF, static_cast<void *>(&req)));
+
+    // the interface's MTU is only available through a socket
+    UDPSocket sock;
+    SystemCall("ioctl", ioctl(sock.fd_num(), SIOCGIFMTU, static_cast<void *>(&req)));
+    return req.ifr_mtu;
 }
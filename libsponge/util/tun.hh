@@ -3,13 +3,23 @@
 
 #include "file_descriptor.hh"
 
+#include <cstddef>
 #include <string>
 
 //! A FileDescriptor to a [Linux TUN/TAP](https://www.kernel.org/doc/Documentation/networking/tuntap.txt) device
 class TunTapFD : public FileDescriptor {
+  private:
+    size_t _max_packet_size;  //!< The largest datagram (TUN) or frame (TAP) at the MTU the device was opened with
+
   public:
     //! Open an existing persistent [TUN or TAP device](https://www.kernel.org/doc/Documentation/networking/tuntap.txt).
     explicit TunTapFD(const std::string &devname, const bool is_tun);
+
+    //! The device's MTU: the largest IP datagram it carries
+    size_t mtu() const;
+
+    //! Read one datagram (TUN) or frame (TAP) into a Buffer from the packet pool
+    Buffer read_packet() { return FileDescriptor::read_packet(_max_packet_size); }
 };
 
 //! A FileDescriptor to a [Linux TUN](https://www.kernel.org/doc/Documentation/networking/tuntap.txt) device
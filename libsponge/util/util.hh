@@ -54,12 +54,23 @@ uint64_t timestamp_ms();
 //! The internet checksum algorithm
 class InternetChecksum {
   private:
-    uint32_t _sum;
-    bool _parity{};
+    uint64_t _sum;   //!< sum of the big-endian 16-bit words so far, folded only in value()
+    bool _parity{};  //!< whether an odd number of bytes has been added
+
+    //! Add `data` to the sum, also copying it to `dest` if `copy`
+    template <bool copy>
+    void add_bytes(std::string_view data, char *dest);
 
   public:
     InternetChecksum(const uint32_t initial_sum = 0);
     void add(std::string_view data);
+
+    //! Copy `data` to `dest` while adding it to the sum, in a single pass over the bytes
+    void add_copy(char *dest, std::string_view data);
+
+    //! Add the sum that `other` computed over bytes that follow the ones added so far
+    void add(const InternetChecksum &other);
+
     uint16_t value() const;
 };
 
@@ -0,0 +1,92 @@
+#include "buffer.hh"
+
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+
+using namespace std;
+
+int main() {
+    try {
+        {
+            // a slice shares the storage and stays valid after the source goes away
+            Buffer source{string("hello, world")};
+            const char *data = source.str().data();
+            Buffer middle = source.substr(3, 4);
+            if (middle.str() != "lo, " or middle.str().data() != data + 3) {
+                throw runtime_error("substr: wrong or copied slice");
+            }
+            source = Buffer{};
+            middle.remove_prefix(1);
+            if (middle.copy() != "o, " or middle.substr(1).copy() != ", " or middle.substr(3).size() != 0) {
+                throw runtime_error("substr: slice changed when the source went away");
+            }
+            if (source.substr(0).size() != 0) {
+                throw runtime_error("substr: slice of an empty Buffer isn't empty");
+            }
+
+            bool threw = false;
+            try {
+                middle.substr(4);
+            } catch (const out_of_range &) {
+                threw = true;
+            }
+            if (not threw) {
+                throw runtime_error("substr: no exception for a position past the end");
+            }
+        }
+
+        {
+            // a slice across Buffers keeps the pieces it touches, trimmed
+            BufferList list{string("header")};
+            list.append(BufferList{string("payload")});
+            list.append(BufferList{string("trailer")});
+
+            const BufferList body = list.slice(4, 11);
+            if (body.buffers().size() != 3 or body.concatenate() != "erpayloadtr") {
+                throw runtime_error("slice: wrong bytes across Buffers");
+            }
+            if (body.buffers()[1].str().data() != list.buffers()[1].str().data()) {
+                throw runtime_error("slice: copied a whole Buffer");
+            }
+            if (list.slice(6).concatenate() != "payloadtrailer" or list.slice(6).buffers().size() != 2) {
+                throw runtime_error("slice: wrong tail");
+            }
+            if (list.slice(20, 100).concatenate() != "" or list.slice(20, 100).buffers().size() != 0) {
+                throw runtime_error("slice: slice at the end isn't empty");
+            }
+        }
+
+        {
+            // more Buffers than a BufferList holds inline, removed from the front across several of them
+            BufferList list;
+            string expected;
+            for (size_t i = 0; i < 3 * BufferList::INLINE_CAPACITY; i++) {
+                list.append(BufferList{to_string(i) + ";"});
+                expected += to_string(i) + ";";
+            }
+            const BufferList copy = list;
+            list.remove_prefix(9);
+            if (list.concatenate() != expected.substr(9) or copy.concatenate() != expected) {
+                throw runtime_error("remove_prefix: wrong bytes left in a long BufferList");
+            }
+
+            BufferViewList views{copy};
+            views.remove_prefix(21);
+            string gathered;
+            for (const auto &iov : views.as_iovecs()) {
+                gathered.append(static_cast<const char *>(iov.iov_base), iov.iov_len);
+            }
+            if (gathered != expected.substr(21) or views.size() != gathered.size()) {
+                throw runtime_error("as_iovecs: wrong bytes from a long BufferViewList");
+            }
+        }
+    } catch (const exception &e) {
+        cerr << "Exception: " << e.what() << endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
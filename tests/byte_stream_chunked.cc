@@ -0,0 +1,76 @@
+#include "byte_stream.hh"
+#include "byte_stream_test_harness.hh"
+
+#include <exception>
+#include <iostream>
+
+using namespace std;
+
+int main() {
+    try {
+        {
+            ByteStreamTestHarness test{"chunked: write-write-pop-write", 8, ByteStream::Storage::Chunked};
+
+            test.execute(Write{"cat"}.with_bytes_written(3));
+            test.execute(Write{"tac"}.with_bytes_written(3));
+            test.execute(Peek{"cattac"});
+            test.execute(Pop{4});
+            test.execute(BufferSize{2});
+            test.execute(Peek{"ac"});
+            test.execute(Write{"dogdog"}.with_bytes_written(6));
+            test.execute(RemainingCapacity{0});
+            test.execute(Peek{"acdogdog"});
+            test.execute(EndInput{});
+            test.execute(Pop{8});
+            test.execute(Eof{true});
+            test.execute(BytesRead{12});
+            test.execute(BytesWritten{12});
+        }
+
+        {
+            ByteStreamTestHarness test{"chunked: overwrite", 2, ByteStream::Storage::Chunked};
+
+            test.execute(Write{"cat"}.with_bytes_written(2));
+            test.execute(Write{"t"}.with_bytes_written(0));
+            test.execute(Peek{"ca"});
+            test.execute(Pop{1});
+            test.execute(Write{"tac"}.with_bytes_written(1));
+            test.execute(Peek{"at"});
+        }
+
+        {
+            // owned writes and read_buffers() hand chunks through without copying them
+            ByteStream bs{16, ByteStream::Storage::Chunked};
+            Buffer first{string("hello")};
+            const char *first_data = first.str().data();
+            if (bs.write(first) != 5 or bs.write(string(" world")) != 6) {
+                throw runtime_error("chunked: owned writes were not fully accepted");
+            }
+
+            BufferList out = bs.read_buffers(5);
+            if (out.buffers().size() != 1 or out.buffers().front().str().data() != first_data) {
+                throw runtime_error("chunked: read_buffers() copied a whole chunk");
+            }
+
+            out = bs.read_buffers(3);
+            if (out.concatenate() != " wo" or bs.peek_output(10) != "rld" or bs.bytes_read() != 8) {
+                throw runtime_error("chunked: read_buffers() mishandled a partial chunk");
+            }
+            // the front of a split chunk is a slice of it, not a copy
+            const auto rest = static_cast<const char *>(bs.peek_views(3).as_iovecs().front().iov_base);
+            if (out.buffers().front().str().data() + 3 != rest) {
+                throw runtime_error("chunked: read_buffers() copied the front of a split chunk");
+            }
+
+            const size_t accepted = bs.write(Buffer{string("0123456789abcdef")});
+            if (accepted != 13 or bs.read_buffers(100).concatenate() != "rld0123456789abc") {
+                throw runtime_error("chunked: oversized Buffer was not truncated to the remaining capacity");
+            }
+        }
+    } catch (const exception &e) {
+        cerr << "Exception: " << e.what() << endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,268 @@
+#include "eventloop.hh"
+#include "socket.hh"
+#include "util.hh"
+
+#ifdef SPONGE_IO_URING
+#include "io_uring.hh"
+#endif
+
+#include <algorithm>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <poll.h>
+#include <stdexcept>
+#include <string>
+#include <sys/socket.h>
+#include <utility>
+#include <vector>
+
+using namespace std;
+
+//! \returns a pair of connected, non-blocking Unix-domain stream sockets
+pair<LocalStreamSocket, LocalStreamSocket> stream_pair() {
+    int fds[2];
+    SystemCall("socketpair", ::socketpair(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK, 0, static_cast<int *>(fds)));
+    return {LocalStreamSocket(FileDescriptor(fds[0])), LocalStreamSocket(FileDescriptor(fds[1]))};
+}
+
+void check_backend(const EventLoop::Backend backend, const string &name) {
+    // only the rules for ready fds are called, out of many that are always of interest
+    {
+        EventLoop loop{backend};
+        vector<UDPSocket> sockets(500);
+        vector<unsigned> received(sockets.size());
+        for (size_t i = 0; i < sockets.size(); i++) {
+            sockets[i].bind(Address("127.0.0.1", 0));
+            loop.add_rule(sockets[i], Direction::In, [&, i] {
+                sockets[i].recv();
+                received[i]++;
+            });
+        }
+
+        UDPSocket sender;
+        for (const size_t i : {3, 250, 499}) {
+            sender.sendto(sockets[i].local_address(), "hello");
+        }
+        unsigned total = 0;
+        while (total < 3) {
+            if (loop.wait_next_event(1000) != EventLoop::Result::Success) {
+                throw runtime_error(name + ": datagrams weren't delivered");
+            }
+            total = 0;
+            for (const unsigned count : received) {
+                total += count;
+            }
+        }
+        if (received[3] != 1 or received[250] != 1 or received[499] != 1 or total != 3) {
+            throw runtime_error(name + ": wrong rules called");
+        }
+        if (loop.wait_next_event(0) != EventLoop::Result::Timeout) {
+            throw runtime_error(name + ": no timeout with nothing ready");
+        }
+    }
+
+    // a rule is only waited for while it's interested, and EOF cancels it
+    {
+        EventLoop loop{backend};
+        auto [ours, theirs] = stream_pair();
+        bool want_to_write = false, canceled = false;
+        string got;
+        loop.add_rule(
+            ours,
+            Direction::Out,
+            [&] {
+                ours.write("ping");
+                want_to_write = false;
+            },
+            [&] { return want_to_write; });
+        loop.add_rule(
+            theirs,
+            Direction::In,
+            [&] { got += theirs.read(); },
+            [] { return true; },
+            [&] { canceled = true; });
+
+        // the writable fd isn't reported until its rule is interested
+        if (loop.wait_next_event(0) != EventLoop::Result::Timeout) {
+            throw runtime_error(name + ": uninterested rule was called");
+        }
+        want_to_write = true;
+        while (got != "ping") {
+            if (loop.wait_next_event(1000) != EventLoop::Result::Success) {
+                throw runtime_error(name + ": write wasn't read");
+            }
+        }
+
+        // (the poll backend cancels the rule on the wait after the one that read the EOF)
+        ours.shutdown(SHUT_WR);
+        while (not canceled) {
+            if (loop.wait_next_event(1000) == EventLoop::Result::Timeout) {
+                throw runtime_error(name + ": rule wasn't canceled at EOF");
+            }
+        }
+        if (loop.wait_next_event(0) != EventLoop::Result::Exit) {
+            throw runtime_error(name + ": no exit with nothing left to wait for");
+        }
+    }
+
+    // a rule whose fd is closed is canceled, and its fd number can be used again
+    {
+        EventLoop loop{backend};
+        UDPSocket first;
+        first.bind(Address("127.0.0.1", 0));
+        const int fd_num = first.fd_num();
+        loop.add_rule(first, Direction::In, [&] {
+            first.recv();
+            first.close();
+        });
+        UDPSocket{}.sendto(first.local_address(), "bye");
+        if (loop.wait_next_event(1000) != EventLoop::Result::Success or
+            loop.wait_next_event(0) != EventLoop::Result::Exit) {
+            throw runtime_error(name + ": rule wasn't canceled when its fd was closed");
+        }
+
+        UDPSocket second;
+        second.bind(Address("127.0.0.1", 0));
+        if (second.fd_num() != fd_num) {
+            throw runtime_error(name + ": fd number wasn't reused");
+        }
+        bool called = false;
+        loop.add_rule(second, Direction::In, [&] {
+            second.recv();
+            called = true;
+        });
+        UDPSocket{}.sendto(second.local_address(), "hello again");
+        if (loop.wait_next_event(1000) != EventLoop::Result::Success or not called) {
+            throw runtime_error(name + ": reused fd number wasn't waited for");
+        }
+    }
+
+    // a rule without an interest callback is canceled when its fd is closed outside the loop
+    {
+        EventLoop loop{backend};
+        UDPSocket socket;
+        socket.bind(Address("127.0.0.1", 0));
+        bool canceled = false;
+        loop.add_rule(
+            socket,
+            Direction::In,
+            [&] { socket.recv(); },
+            {},
+            [&] { canceled = true; });
+        socket.close();
+        if (loop.wait_next_event(200) != EventLoop::Result::Exit or not canceled) {
+            throw runtime_error(name + ": rule wasn't canceled when its fd was closed outside the loop");
+        }
+    }
+
+    // a callback that neither reads nor loses interest is a busy wait
+    {
+        EventLoop loop{backend};
+        auto [ours, theirs] = stream_pair();
+        loop.add_rule(ours, Direction::Out, [] {});
+        bool threw = false;
+        try {
+            loop.wait_next_event(1000);
+        } catch (const runtime_error &) {
+            threw = true;
+        }
+        if (not threw) {
+            throw runtime_error(name + ": busy wait wasn't detected");
+        }
+    }
+}
+
+#ifdef SPONGE_IO_URING
+//! A UDP socket given to batch_packets() gets its datagrams (with their sources) in order, and its sends go out
+void check_batched_packets() {
+    EventLoop loop{EventLoop::Backend::IOUring};
+    UDPSocket echo, client;
+    echo.bind(Address("127.0.0.1", 0));
+    client.bind(Address("127.0.0.1", 0));
+    loop.batch_packets(echo, 1500);
+
+    // more datagrams than the IOUring has Buffers for, so some wait in the kernel until earlier ones are taken
+    const size_t count = 2 * IOUring::RECEIVE_BUFFERS;
+    size_t echoed = 0;
+    loop.add_rule(echo, Direction::In, [&] {
+        auto datagram = echo.recv();
+        if (datagram.payload.copy() != to_string(echoed) or datagram.source_address != client.local_address()) {
+            throw runtime_error("io_uring: wrong datagram received");
+        }
+        echo.send_packet(datagram.source_address, BufferList(move(datagram.payload)));
+        echoed++;
+    });
+    for (size_t i = 0; i < count; i++) {
+        client.sendto(echo.local_address(), to_string(i));
+    }
+    while (echoed < count) {
+        if (loop.wait_next_event(1000) != EventLoop::Result::Success) {
+            throw runtime_error("io_uring: datagrams weren't delivered");
+        }
+    }
+    loop.wait_next_event(0);  // (submits the last sends)
+
+    client.set_blocking(true);
+    for (size_t i = 0; i < count; i++) {
+        if (client.recv().payload.copy() != to_string(i)) {
+            throw runtime_error("io_uring: wrong datagram echoed");
+        }
+    }
+}
+
+//! More entries than the submission queue holds can be queued between waits, and an IOUring is destroyed
+//! (after draining everything in flight) even when sends have failed
+void check_io_uring_queue() {
+    {
+        auto [ours, theirs] = stream_pair();
+        IOUring ring;
+        const size_t count = 300;
+        vector<unsigned> polled(count);
+        for (size_t i = 0; i < count; i++) {
+            ring.arm_poll(ours.fd_num(), POLLOUT, &polled[i]);
+        }
+        size_t total = 0;
+        for (unsigned waits = 0; total < count and waits < 100; waits++) {
+            ring.wait(10);
+            for (const auto &poll : ring.polls()) {
+                (*static_cast<unsigned *>(poll.token))++;
+                total++;
+            }
+        }
+        if (total != count or find(polled.begin(), polled.end(), 0) != polled.end()) {
+            throw runtime_error("io_uring: polls queued past the submission queue's size went wrong");
+        }
+    }
+
+    UDPSocket socket;
+    socket.bind(Address("127.0.0.1", 0));
+    IOUring ring;
+    ring.add_packet_source(socket, 1500);
+    // (the destructor submits these, and reports each failure as it drains them)
+    for (size_t i = 0; i < 10; i++) {
+        socket.send_packet(Address("127.0.0.1", 0), BufferList(string("nowhere")));
+    }
+}
+#endif
+
+int main() {
+    try {
+        check_backend(EventLoop::Backend::Epoll, "epoll");
+        check_backend(EventLoop::Backend::Poll, "poll");
+#ifdef SPONGE_IO_URING
+        if (EventLoop::fastest_backend() == EventLoop::Backend::IOUring) {
+            check_backend(EventLoop::Backend::IOUring, "io_uring");
+            check_batched_packets();
+            check_io_uring_queue();
+        } else {
+            cerr << "io_uring is unavailable; skipping its tests\n";
+        }
+#endif
+    } catch (const exception &e) {
+        cerr << "Exception: " << e.what() << endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
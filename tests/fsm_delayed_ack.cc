@@ -0,0 +1,76 @@
+#include "tcp_config.hh"
+#include "tcp_expectation.hh"
+#include "tcp_fsm_test_harness.hh"
+#include "tcp_header.hh"
+#include "tcp_segment.hh"
+#include "util.hh"
+
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <string>
+
+using namespace std;
+using State = TCPTestHarness::State;
+
+int main() {
+    try {
+        auto rd = get_random_generator();
+        TCPConfig cfg{};
+        cfg.delayed_ack = true;
+        const string d(3000, 'x');
+
+        // test 1: every second full-sized segment is ACKed, and a lone one within the delay
+        {
+            const WrappingInt32 rx_isn(rd());
+            const WrappingInt32 tx_isn(rd());
+            TCPTestHarness test_1 = TCPTestHarness::in_established(cfg, tx_isn, rx_isn);
+            test_1.send_data(rx_isn + 1, tx_isn + 1, d.cbegin(), d.cbegin() + 1000);
+            test_1.execute(ExpectNoSegment{}, "test 1 failed: first segment ACKed right away");
+            test_1.send_data(rx_isn + 1001, tx_isn + 1, d.cbegin() + 1000, d.cbegin() + 2000);
+            test_1.execute(ExpectOneSegment{}.with_ack(true).with_ackno(rx_isn + 2001).with_payload_size(0),
+                           "test 1 failed: second segment not ACKed");
+
+            test_1.send_data(rx_isn + 2001, tx_isn + 1, d.cbegin() + 2000, d.cend());
+            test_1.execute(Tick(TCPConfig::ACK_DELAY_DFLT - 1));
+            test_1.execute(ExpectNoSegment{}, "test 1 failed: ACK sent before the delay");
+            test_1.execute(Tick(1));
+            test_1.execute(ExpectOneSegment{}.with_ack(true).with_ackno(rx_isn + 3001).with_payload_size(0),
+                           "test 1 failed: delayed ACK not sent");
+        }
+
+        // test 2: out-of-order segments, and the one that fills the hole, are ACKed right away
+        {
+            const WrappingInt32 rx_isn(rd());
+            const WrappingInt32 tx_isn(rd());
+            TCPTestHarness test_2 = TCPTestHarness::in_established(cfg, tx_isn, rx_isn);
+            test_2.send_data(rx_isn + 1001, tx_isn + 1, d.cbegin() + 1000, d.cbegin() + 2000);
+            test_2.execute(ExpectOneSegment{}.with_ack(true).with_ackno(rx_isn + 1),
+                           "test 2 failed: out-of-order segment not ACKed");
+            test_2.send_data(rx_isn + 1, tx_isn + 1, d.cbegin(), d.cbegin() + 1000);
+            test_2.execute(ExpectOneSegment{}.with_ack(true).with_ackno(rx_isn + 2001),
+                           "test 2 failed: segment filling the hole not ACKed");
+        }
+
+        // test 3: the pending ACK rides on outgoing data
+        {
+            const WrappingInt32 rx_isn(rd());
+            const WrappingInt32 tx_isn(rd());
+            TCPTestHarness test_3 = TCPTestHarness::in_established(cfg, tx_isn, rx_isn);
+            test_3.send_data(rx_isn + 1, tx_isn + 1, d.cbegin(), d.cbegin() + 1000);
+            test_3.execute(ExpectNoSegment{});
+            test_3.execute(Write{string(100, 'y')});
+            test_3.execute(ExpectOneSegment{}.with_ack(true).with_ackno(rx_isn + 1001).with_payload_size(100),
+                           "test 3 failed: data didn't carry the ACK");
+            test_3.execute(Tick(TCPConfig::ACK_DELAY_DFLT));
+            test_3.execute(ExpectNoSegment{}, "test 3 failed: ACK sent twice");
+            test_3.execute(ExpectState{State::ESTABLISHED});
+        }
+    } catch (const exception &e) {
+        cerr << e.what() << endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,106 @@
+#include "tcp_config.hh"
+#include "tcp_expectation.hh"
+#include "tcp_fsm_test_harness.hh"
+#include "tcp_header.hh"
+#include "tcp_segment.hh"
+#include "util.hh"
+
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <string>
+
+using namespace std;
+using State = TCPTestHarness::State;
+
+int main() {
+    try {
+        auto rd = get_random_generator();
+        TCPConfig cfg{};
+        const string d(1000, 'x');
+
+        // test 1: in-order data on an established connection is ACKed and reaches the stream
+        {
+            const WrappingInt32 rx_isn(rd());
+            const WrappingInt32 tx_isn(rd());
+            TCPTestHarness test_1 = TCPTestHarness::in_established(cfg, tx_isn, rx_isn);
+            test_1.send_data(rx_isn + 1, tx_isn + 1, d.cbegin(), d.cend());
+            test_1.execute(ExpectOneSegment{}.with_ack(true).with_ackno(rx_isn + 1001).with_payload_size(0),
+                           "test 1 failed: in-order data not ACKed");
+            test_1.execute(ExpectData{}.with_data(d), "test 1 failed: in-order data not delivered");
+            test_1.send_data(rx_isn + 1001, tx_isn + 1, d.cbegin(), d.cend());
+            test_1.execute(ExpectOneSegment{}.with_ack(true).with_ackno(rx_isn + 2001).with_payload_size(0),
+                           "test 1 failed: second in-order segment not ACKed");
+            test_1.execute(ExpectState{State::ESTABLISHED});
+        }
+
+        // test 2: a pure ACK for new data empties the flight without an answer
+        {
+            const WrappingInt32 rx_isn(rd());
+            const WrappingInt32 tx_isn(rd());
+            TCPTestHarness test_2 = TCPTestHarness::in_established(cfg, tx_isn, rx_isn);
+            test_2.execute(Write{string(100, 'y')});
+            test_2.execute(ExpectOneSegment{}.with_seqno(tx_isn + 1).with_payload_size(100));
+            test_2.execute(ExpectBytesInFlight{100});
+            test_2.send_ack(rx_isn + 1, tx_isn + 101);
+            test_2.execute(ExpectBytesInFlight{0}, "test 2 failed: pure ACK not processed");
+            test_2.execute(ExpectNoSegment{}, "test 2 failed: pure ACK answered");
+            test_2.execute(ExpectState{State::ESTABLISHED});
+        }
+
+        // test 3: in-order data filling the gap before an early FIN acknowledges the FIN too
+        {
+            const WrappingInt32 rx_isn(rd());
+            const WrappingInt32 tx_isn(rd());
+            TCPTestHarness test_3 = TCPTestHarness::in_established(cfg, tx_isn, rx_isn);
+            test_3.send_fin(rx_isn + 101, tx_isn + 1);
+            test_3.execute(ExpectOneSegment{}.with_ack(true).with_ackno(rx_isn + 1),
+                           "test 3 failed: out-of-order FIN not ACKed");
+            test_3.send_data(rx_isn + 1, tx_isn + 1, d.cbegin(), d.cbegin() + 100);
+            test_3.execute(ExpectOneSegment{}.with_ack(true).with_ackno(rx_isn + 102).with_payload_size(0),
+                           "test 3 failed: FIN not ACKed once the gap was filled");
+            test_3.execute(ExpectState{State::CLOSE_WAIT});
+
+            // the peer finished first, so there is no lingering after our FIN is ACKed
+            test_3.execute(Close{});
+            test_3.execute(ExpectOneSegment{}.with_fin(true).with_seqno(tx_isn + 1).with_ackno(rx_isn + 102));
+            test_3.send_ack(rx_isn + 102, tx_isn + 2);
+            test_3.execute(Tick(1));
+            test_3.execute(ExpectState{State::CLOSED}, "test 3 failed: lingered after a passive close");
+        }
+
+        // test 4: a pure ACK that covers a retransmission gives no RTT sample, so the backed-off RTO stays
+        {
+            TCPConfig rto_cfg{};
+            rto_cfg.adaptive_rto = true;
+            rto_cfg.min_rto = 20;
+            const WrappingInt32 rx_isn(rd());
+            const WrappingInt32 tx_isn(rd());
+            TCPTestHarness test_4 = TCPTestHarness::in_established(rto_cfg, tx_isn, rx_isn);
+            test_4.send_ack(rx_isn + 1, tx_isn + 1, 4000);
+            test_4.execute(Write{string(3000, 'z')});
+            for (unsigned int i = 0; i < 3; i++) {
+                test_4.execute(ExpectSegment{}.with_seqno(tx_isn + 1 + 1000 * i).with_payload_size(1000));
+            }
+            test_4.execute(Tick(20));
+            test_4.execute(ExpectOneSegment{}.with_seqno(tx_isn + 1).with_payload_size(1000),
+                           "test 4 failed: no retransmission");
+
+            test_4.execute(Tick(10));
+            test_4.send_ack(rx_isn + 1, tx_isn + 3001, 4000);
+            test_4.execute(Write{"abcd"});
+            test_4.execute(ExpectOneSegment{}.with_seqno(tx_isn + 3001).with_payload_size(4));
+            test_4.execute(Tick(39));
+            test_4.execute(ExpectNoSegment{}, "test 4 failed: RTO sampled through a retransmission");
+            test_4.execute(Tick(1));
+            test_4.execute(ExpectOneSegment{}.with_seqno(tx_isn + 3001).with_payload_size(4),
+                           "test 4 failed: backed-off RTO not kept");
+        }
+    } catch (const exception &e) {
+        cerr << e.what() << endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,69 @@
+#include "tcp_config.hh"
+#include "tcp_expectation.hh"
+#include "tcp_fsm_test_harness.hh"
+#include "tcp_header.hh"
+#include "tcp_segment.hh"
+#include "util.hh"
+
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <string>
+
+using namespace std;
+using State = TCPTestHarness::State;
+
+int main() {
+    try {
+        auto rd = get_random_generator();
+        TCPConfig cfg{};
+        cfg.mss = 900;
+
+        // test 1: the SYN advertises our MSS, and the smaller of the two is used for sending
+        {
+            const WrappingInt32 tx_isn(rd());
+            const WrappingInt32 rx_isn(rd());
+            TCPTestHarness test_1 = TCPTestHarness::in_syn_sent(cfg, tx_isn);
+            test_1.execute(SendSegment{}
+                               .with_syn(true)
+                               .with_ack(true)
+                               .with_seqno(rx_isn)
+                               .with_ackno(tx_isn + 1)
+                               .with_win(10000)
+                               .with_mss(600));
+            test_1.execute(ExpectOneSegment{}.with_ack(true).with_ackno(rx_isn + 1).with_payload_size(0));
+            test_1.execute(Write{string(1500, 'x')});
+            test_1.execute(ExpectSegment{}.with_seqno(tx_isn + 1).with_payload_size(600));
+            test_1.execute(ExpectSegment{}.with_seqno(tx_isn + 601).with_payload_size(600));
+            test_1.execute(ExpectSegment{}.with_seqno(tx_isn + 1201).with_payload_size(300));
+            test_1.execute(ExpectNoSegment{});
+        }
+
+        // test 2: a SYN without the option means the peer takes 536-byte segments
+        {
+            const WrappingInt32 seq_base(rd());
+            TCPTestHarness test_2(cfg);
+            test_2.execute(Listen{});
+            test_2.execute(SendSegment{}.with_syn(true).with_seqno(seq_base).with_win(10000));
+            TCPSegment seg = test_2.expect_seg(ExpectOneSegment{}.with_syn(true).with_ack(true),
+                                               "test 2 failed: no SYN/ACK");
+            if (seg.header().mss != cfg.mss) {
+                throw runtime_error("test 2 failed: SYN/ACK without our MSS: " + seg.header().summary());
+            }
+            const WrappingInt32 ack_base = seg.header().seqno;
+
+            test_2.send_ack(seq_base + 1, ack_base + 1, 10000);
+            test_2.execute(ExpectState{State::ESTABLISHED});
+            test_2.execute(Write{string(1000, 'x')});
+            test_2.execute(ExpectSegment{}.with_payload_size(TCPConfig::DEFAULT_PEER_MSS));
+            test_2.execute(ExpectSegment{}.with_payload_size(1000 - TCPConfig::DEFAULT_PEER_MSS));
+            test_2.execute(ExpectNoSegment{});
+        }
+    } catch (const exception &e) {
+        cerr << e.what() << endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
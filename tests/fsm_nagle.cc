@@ -0,0 +1,80 @@
+#include "tcp_config.hh"
+#include "tcp_expectation.hh"
+#include "tcp_fsm_test_harness.hh"
+#include "tcp_header.hh"
+#include "tcp_segment.hh"
+#include "util.hh"
+
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <string>
+
+using namespace std;
+using State = TCPTestHarness::State;
+
+int main() {
+    try {
+        auto rd = get_random_generator();
+
+        // test 1: with Nagle's algorithm, small writes wait for the outstanding data to be acknowledged
+        {
+            TCPConfig cfg{};
+            cfg.nagle = true;
+            const WrappingInt32 rx_isn(rd());
+            const WrappingInt32 tx_isn(rd());
+            TCPTestHarness test_1 = TCPTestHarness::in_established(cfg, tx_isn, rx_isn);
+            test_1.send_ack(rx_isn + 1, tx_isn + 1, 10000);
+            test_1.execute(Write{string(100, 'a')});
+            test_1.execute(ExpectOneSegment{}.with_seqno(tx_isn + 1).with_payload_size(100),
+                           "test 1 failed: nothing in flight, but the write wasn't sent");
+            test_1.execute(Write{string(100, 'b')});
+            test_1.execute(Write{string(100, 'c')});
+            test_1.execute(ExpectNoSegment{}, "test 1 failed: small segment sent with data in flight");
+            test_1.send_ack(rx_isn + 1, tx_isn + 101, 10000);
+            test_1.execute(ExpectOneSegment{}.with_seqno(tx_isn + 101).with_payload_size(200),
+                           "test 1 failed: held writes not coalesced");
+
+            // full segments go right away; only the tail waits
+            test_1.execute(Write{string(2500, 'd')});
+            test_1.execute(ExpectSegment{}.with_seqno(tx_isn + 301).with_payload_size(1000));
+            test_1.execute(ExpectSegment{}.with_seqno(tx_isn + 1301).with_payload_size(1000));
+            test_1.execute(ExpectNoSegment{}, "test 1 failed: tail sent with data in flight");
+            test_1.send_ack(rx_isn + 1, tx_isn + 2301, 10000);
+            test_1.execute(ExpectOneSegment{}.with_seqno(tx_isn + 2301).with_payload_size(500),
+                           "test 1 failed: tail not sent once everything was acknowledged");
+        }
+
+        // test 2: a corked connection sends only full segments until it's uncorked or the stream ends
+        {
+            TCPConfig cfg{};
+            const WrappingInt32 rx_isn(rd());
+            const WrappingInt32 tx_isn(rd());
+            TCPTestHarness test_2 = TCPTestHarness::in_established(cfg, tx_isn, rx_isn);
+            test_2.send_ack(rx_isn + 1, tx_isn + 1, 10000);
+            test_2.execute(Cork{true});
+            test_2.execute(Write{string(500, 'a')});
+            test_2.execute(ExpectNoSegment{}, "test 2 failed: partial segment sent while corked");
+            test_2.execute(Write{string(600, 'b')});
+            test_2.execute(ExpectOneSegment{}.with_seqno(tx_isn + 1).with_payload_size(1000),
+                           "test 2 failed: full segment held while corked");
+            test_2.execute(Cork{false});
+            test_2.execute(ExpectOneSegment{}.with_seqno(tx_isn + 1001).with_payload_size(100),
+                           "test 2 failed: uncork didn't send the rest");
+
+            test_2.execute(Cork{true});
+            test_2.execute(Write{string(10, 'c')});
+            test_2.execute(ExpectNoSegment{});
+            test_2.execute(Close{});
+            test_2.execute(ExpectOneSegment{}.with_seqno(tx_isn + 1101).with_payload_size(10).with_fin(true),
+                           "test 2 failed: end of the stream held while corked");
+            test_2.execute(ExpectState{State::FIN_WAIT_1});
+        }
+    } catch (const exception &e) {
+        cerr << e.what() << endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
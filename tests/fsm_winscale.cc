@@ -0,0 +1,85 @@
+#include "tcp_config.hh"
+#include "tcp_expectation.hh"
+#include "tcp_fsm_test_harness.hh"
+#include "tcp_header.hh"
+#include "tcp_segment.hh"
+#include "util.hh"
+
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <string>
+
+using namespace std;
+using State = TCPTestHarness::State;
+
+int main() {
+    try {
+        auto rd = get_random_generator();
+        TCPConfig cfg{};
+        cfg.recv_capacity = 1000000;  // needs a shift of 4 to fit in 16 bits
+        cfg.send_capacity = 20000;
+
+        // test 1: both sides scale; the SYN's own window is never scaled
+        {
+            const WrappingInt32 seq_base(rd());
+            TCPTestHarness test_1(cfg);
+            test_1.execute(Listen{});
+            test_1.execute(SendSegment{}.with_syn(true).with_seqno(seq_base).with_mss(1000).with_wscale(2));
+
+            TCPSegment seg = test_1.expect_seg(
+                ExpectOneSegment{}.with_syn(true).with_ack(true).with_ackno(seq_base + 1).with_win(65535).with_wscale(4),
+                "test 1 failed: SYN/ACK without the window-scale option");
+            const WrappingInt32 ack_base = seg.header().seqno;
+
+            // 1000 << 2 bytes of send window
+            test_1.send_ack(seq_base + 1, ack_base + 1, 1000);
+            test_1.execute(ExpectState{State::ESTABLISHED});
+            test_1.execute(Write{string(10000, 'x')});
+            test_1.execute(Tick(1));
+            for (unsigned i = 0; i < 4; i++) {
+                test_1.execute(ExpectSegment{}
+                                   .with_seqno(ack_base + 1 + 1000 * i)
+                                   .with_payload_size(1000)
+                                   .with_win(1000000 >> 4)
+                                   .with_wscale(nullopt),
+                               "test 1 failed: data not sent with a scaled window");
+            }
+            test_1.execute(ExpectNoSegment{}, "test 1 failed: sent past the scaled window");
+        }
+
+        // test 2: the peer doesn't scale, so neither side does and the window is clamped
+        {
+            const WrappingInt32 seq_base(rd());
+            TCPTestHarness test_2(cfg);
+            test_2.execute(Listen{});
+            test_2.execute(SendSegment{}.with_syn(true).with_seqno(seq_base).with_mss(1000));
+
+            TCPSegment seg = test_2.expect_seg(
+                ExpectOneSegment{}.with_syn(true).with_ack(true).with_win(65535).with_wscale(nullopt),
+                "test 2 failed: SYN/ACK offered window scaling to a peer that didn't");
+            const WrappingInt32 ack_base = seg.header().seqno;
+
+            test_2.send_ack(seq_base + 1, ack_base + 1, 1000);
+            test_2.execute(Write{string(10000, 'x')});
+            test_2.execute(Tick(1));
+            test_2.execute(ExpectSegment{}.with_payload_size(1000).with_win(65535),
+                           "test 2 failed: window not clamped to 16 bits");
+            test_2.execute(ExpectNoSegment{}, "test 2 failed: sent past the unscaled window");
+        }
+
+        // test 3: an active open offers the option
+        {
+            TCPTestHarness test_3(cfg);
+            test_3.execute(Connect{});
+            test_3.execute(ExpectOneSegment{}.with_syn(true).with_ack(false).with_win(65535).with_wscale(4),
+                           "test 3 failed: SYN without the window-scale option");
+        }
+    } catch (const exception &e) {
+        cerr << e.what() << endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
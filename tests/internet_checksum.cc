@@ -0,0 +1,139 @@
+#include "tcp_segment.hh"
+#include "util.hh"
+
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <random>
+#include <stdexcept>
+#include <string>
+
+using namespace std;
+
+//! The byte-at-a-time checksum that InternetChecksum used to compute
+uint16_t reference_checksum(const uint32_t initial_sum, const string &data) {
+    uint32_t sum = initial_sum;
+    for (size_t i = 0; i < data.size(); i++) {
+        sum += i % 2 ? uint8_t(data[i]) : uint8_t(data[i]) << 8;
+    }
+    while (sum > 0xffff) {
+        sum = (sum >> 16) + (sum & 0xffff);
+    }
+    return ~sum;
+}
+
+int main() {
+    try {
+        auto rd = get_random_generator();
+
+        // every length up to a few vector widths, then some packet-sized ones, split at random points
+        for (size_t len = 0; len < 4000; len += len < 300 ? 1 : 97) {
+            string data(len, 0);
+            for (auto &ch : data) {
+                ch = rd();
+            }
+            const uint32_t initial_sum = rd() & 0xfffff;
+            const uint16_t expected = reference_checksum(initial_sum, data);
+
+            InternetChecksum whole{initial_sum};
+            whole.add(data);
+            if (whole.value() != expected) {
+                throw runtime_error("wrong checksum for " + to_string(len) + " bytes");
+            }
+
+            InternetChecksum pieces{initial_sum};
+            for (size_t pos = 0; pos < len;) {
+                const size_t piece = min<size_t>(len - pos, rd() % 80);
+                pieces.add(string_view(data).substr(pos, piece));
+                pos += piece;
+            }
+            if (pieces.value() != expected) {
+                throw runtime_error("wrong checksum for " + to_string(len) + " bytes added in pieces");
+            }
+        }
+
+        // copying while summing, and combining sums taken separately, give the same checksum
+        for (size_t len = 0; len < 300; len++) {
+            string data(len, 0);
+            for (auto &ch : data) {
+                ch = rd();
+            }
+            const size_t split = len ? rd() % len : 0;
+            const string_view head = string_view(data).substr(0, split), tail = string_view(data).substr(split);
+
+            string copy(len, 0);
+            InternetChecksum copied{0x1234};
+            copied.add_copy(copy.data(), head);
+            copied.add_copy(copy.data() + split, tail);
+            if (copy != data or copied.value() != reference_checksum(0x1234, data)) {
+                throw runtime_error("add_copy wrong for " + to_string(len) + " bytes split at " + to_string(split));
+            }
+
+            InternetChecksum combined{0x1234}, tail_sum;
+            combined.add(head);
+            tail_sum.add(tail);
+            combined.add(tail_sum);
+            if (combined.value() != reference_checksum(0x1234, data)) {
+                throw runtime_error("combined sum wrong for " + to_string(len) + " bytes split at " +
+                                    to_string(split));
+            }
+        }
+
+        // a segment uses the payload sum it was given, but not once the payload is replaced
+        {
+            TCPSegment seg;
+            seg.header().seqno = WrappingInt32(rd());
+            Buffer payload{string(1001, 'x')};
+            InternetChecksum payload_sum;
+            payload_sum.add(payload);
+            seg.set_payload(payload, payload_sum);
+
+            TCPSegment parsed;
+            if (parsed.parse(seg.serialize(0x4321).concatenate(), 0x4321) != ParseResult::NoError or
+                parsed.payload().copy() != payload.copy()) {
+                throw runtime_error("segment with a cached payload sum doesn't parse");
+            }
+
+            seg.payload() = string(1001, 'y');
+            if (parsed.parse(seg.serialize(0x4321).concatenate(), 0x4321) != ParseResult::NoError) {
+                throw runtime_error("segment used a payload sum for a replaced payload");
+            }
+        }
+
+        // the sum of a segment that carries its own checksum is zero, even at an odd offset in memory
+        {
+            string packet(1 + 1461, 0);
+            for (auto &ch : packet) {
+                ch = rd();
+            }
+            packet[1] = packet[2] = 0;
+            InternetChecksum check;
+            check.add(string_view(packet).substr(1));
+            const uint16_t cksum = check.value();
+            packet[1] = cksum >> 8;
+            packet[2] = cksum & 0xff;
+
+            InternetChecksum verify;
+            verify.add(string_view(packet).substr(1));
+            if (verify.value() != 0) {
+                throw runtime_error("checksummed data doesn't sum to zero");
+            }
+        }
+
+        // a sum of all ones stays all ones
+        {
+            const string ones(4096, char(0xff));
+            InternetChecksum check{0xffff};
+            check.add(ones);
+            if (check.value() != 0) {
+                throw runtime_error("wrong checksum for all-ones data");
+            }
+        }
+    } catch (const exception &e) {
+        cerr << "Exception: " << e.what() << endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -234,6 +234,10 @@ int main(int argc, char **argv) {
                 ipv4_hdr_copy.hlen = 5;
                 ipv4_hdr_copy.len -= 4 * tcp_hdr_orig.doff - TCPHeader::LENGTH;
                 tcp_hdr_copy.doff = 5;
+                tcp_hdr_copy.mss.reset();
+                tcp_hdr_copy.wscale.reset();
+                tcp_hdr_copy.sack_permitted = false;
+                tcp_hdr_copy.sack.clear();
             }  // ipv4_hdr_{orig,copy}, tcp_hdr_{orig,copy} go out of scope
 
             if (!compare_ip_headers_nolen(ip_dgram.header(), ip_dgram_copy.header())) {
@@ -0,0 +1,132 @@
+#include "buffer.hh"
+#include "ethernet_frame.hh"
+#include "ipv4_datagram.hh"
+#include "tcp_segment.hh"
+#include "util.hh"
+
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+
+using namespace std;
+
+int main() {
+    try {
+        auto rd = get_random_generator();
+
+        // headroom is handed out once, and only to a Buffer at the front of the bytes in use
+        {
+            Buffer packet{string(8, '-') + "payload", 8};
+            if (packet.copy() != "payload" or packet.headroom() != 8) {
+                throw runtime_error("wrong Buffer with headroom");
+            }
+            const Buffer earlier_copy = packet;
+            memcpy(packet.prepend(3), "hdr", 3);
+            if (packet.copy() != "hdrpayload" or packet.headroom() != 5 or earlier_copy.copy() != "payload") {
+                throw runtime_error("prepend changed the wrong bytes");
+            }
+            if (earlier_copy.headroom() != 0 or earlier_copy.substr(1).headroom() != 0 or
+                Buffer{string("abc")}.headroom() != 0) {
+                throw runtime_error("headroom offered twice");
+            }
+
+            bool threw = false;
+            try {
+                packet.prepend(6);
+            } catch (const out_of_range &) {
+                threw = true;
+            }
+            if (not threw) {
+                throw runtime_error("no exception for prepending past the headroom");
+            }
+        }
+
+        // a small segment, its datagram and its frame end up as one Buffer that parses back
+        {
+            TCPSegment seg;
+            seg.header().seqno = WrappingInt32(rd());
+            seg.header().ack = true;
+            seg.payload() = string(TCPSegment::MAX_COPIED_PAYLOAD, 'x');
+
+            InternetDatagram dgram;
+            dgram.header().src = rd();
+            dgram.header().dst = rd();
+            dgram.header().len = dgram.header().hlen * 4 + seg.header().doff * 4 + seg.payload().size();
+            dgram.payload() = seg.serialize(dgram.header().pseudo_cksum());
+
+            EthernetFrame frame;
+            frame.header().type = EthernetHeader::TYPE_IPv4;
+            frame.payload() = dgram.serialize();
+            const BufferList out = frame.serialize();
+            if (out.buffers().size() != 1) {
+                throw runtime_error("frame is " + to_string(out.buffers().size()) + " Buffers, not one");
+            }
+
+            EthernetFrame frame_in;
+            InternetDatagram dgram_in;
+            TCPSegment seg_in;
+            if (frame_in.parse(out.buffers().front()) != ParseResult::NoError or
+                dgram_in.parse(frame_in.payload()) != ParseResult::NoError or
+                seg_in.parse(dgram_in.payload(), dgram_in.header().pseudo_cksum()) != ParseResult::NoError or
+                seg_in.header().seqno != seg.header().seqno or seg_in.payload().copy() != seg.payload().copy()) {
+                throw runtime_error("single-Buffer frame doesn't parse back");
+            }
+
+            // serializing the same datagram again can't reuse the headroom, so the header is separate
+            const BufferList again = dgram.serialize();
+            const string expected =
+                dgram_in.header().serialize() + seg.serialize(dgram.header().pseudo_cksum()).concatenate();
+            if (again.buffers().size() != 2 or again.concatenate() != expected) {
+                throw runtime_error("datagram serialized twice came out wrong");
+            }
+            if (frame.serialize().concatenate() != out.concatenate()) {
+                throw runtime_error("frame serialized twice came out wrong");
+            }
+        }
+
+        // a larger payload follows the headers as a Buffer of its own, and isn't copied on any (re)transmission
+        {
+            const string data(1000, 'y');
+            InternetChecksum payload_sum;
+            payload_sum.add(data);
+            TCPSegment seg;
+            seg.header().seqno = WrappingInt32(rd());
+            seg.header().ack = true;
+            seg.set_payload(Buffer{string(data)}, payload_sum);
+
+            for (const auto &transmission : {"first", "second"}) {
+                InternetDatagram dgram;
+                dgram.header().src = rd();
+                dgram.header().dst = rd();
+                dgram.header().len = dgram.header().hlen * 4 + seg.header().doff * 4 + seg.payload().size();
+                dgram.payload() = seg.serialize(dgram.header().pseudo_cksum());
+
+                EthernetFrame frame;
+                frame.header().type = EthernetHeader::TYPE_IPv4;
+                frame.payload() = dgram.serialize();
+                const BufferList out = frame.serialize();
+                if (out.buffers().size() != 2 or out.buffers().back().str().data() != seg.payload().str().data()) {
+                    throw runtime_error(string(transmission) + " frame isn't its headers and the payload's Buffer");
+                }
+
+                EthernetFrame frame_in;
+                InternetDatagram dgram_in;
+                TCPSegment seg_in;
+                if (frame_in.parse(Buffer{out.concatenate()}) != ParseResult::NoError or
+                    dgram_in.parse(frame_in.payload()) != ParseResult::NoError or
+                    seg_in.parse(dgram_in.payload(), dgram_in.header().pseudo_cksum()) != ParseResult::NoError or
+                    seg_in.payload().copy() != data) {
+                    throw runtime_error(string(transmission) + " two-Buffer frame doesn't parse back");
+                }
+            }
+        }
+    } catch (const exception &e) {
+        cerr << "Exception: " << e.what() << endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
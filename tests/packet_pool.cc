@@ -0,0 +1,160 @@
+#include "buffer.hh"
+#include "ipv4_datagram.hh"
+#include "socket.hh"
+#include "tcp_segment.hh"
+
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <iostream>
+#include <new>
+#include <stdexcept>
+#include <string>
+#include <thread>
+
+using namespace std;
+
+//! Number of calls to operator new so far
+size_t allocations = 0;
+
+void *operator new(const size_t size) {
+    allocations++;
+    if (void *ptr = malloc(size ? size : 1)) {
+        return ptr;
+    }
+    throw bad_alloc();
+}
+
+void operator delete(void *ptr) noexcept { free(ptr); }
+
+void operator delete(void *ptr, size_t) noexcept { free(ptr); }
+
+int main() {
+    try {
+        // a block freed goes back to the pool and is the next one handed out
+        {
+            const char *first = Buffer::allocate(1000).prepend(0);
+            Buffer again = Buffer::allocate(1500);
+            if (again.prepend(0) != first or again.headroom() != Buffer::SMALL_BLOCK) {
+                throw runtime_error("block wasn't reused");
+            }
+            char *const dest = again.prepend(again.headroom());
+            memcpy(dest, "abc", 3);
+            again.remove_suffix(again.size() - 3);
+            if (again.copy() != "abc" or again.headroom() != 0) {
+                throw runtime_error("wrong Buffer filled in from the front");
+            }
+        }
+
+        // Buffers that are allocated, filled in, copied and freed don't call malloc once the pool is warm
+        {
+            Buffer::allocate(Buffer::SMALL_BLOCK);
+            const size_t before = allocations;
+            for (size_t i = 0; i < 1000; i++) {
+                Buffer packet = Buffer::allocate(1500);
+                memset(packet.prepend(1500), 'x', 1500);
+                const Buffer slice = packet.substr(20, 100);
+                packet = Buffer{};
+                if (slice.size() != 100 or slice.str().find_first_not_of('x') != string::npos) {
+                    throw runtime_error("wrong slice");
+                }
+            }
+            if (allocations != before) {
+                throw runtime_error(to_string(allocations - before) + " allocations for 1000 pooled Buffers");
+            }
+        }
+
+        // nor do received datagrams (the strings they're compared with are short enough not to allocate)
+        {
+            UDPSocket receiver, sender;
+            receiver.bind(Address("127.0.0.1", 0));
+            for (size_t i = 0; i < 102; i++) {
+                sender.sendto(receiver.local_address(), "datagram " + to_string(i));
+            }
+
+            // a datagram is received into a new block before the previous one is freed, so the pool needs two
+            UDPSocket::received_datagram datagram = receiver.recv();
+            receiver.recv(datagram);
+            const size_t before = allocations;
+            for (size_t i = 2; i < 102; i++) {
+                receiver.recv(datagram);
+                if (datagram.payload.str() != "datagram " + to_string(i)) {
+                    throw runtime_error("wrong datagram received");
+                }
+            }
+            if (allocations != before) {
+                throw runtime_error(to_string(allocations - before) + " allocations receiving 100 datagrams");
+            }
+        }
+
+        // nor does a segment on its way from serialize() to the socket, in a datagram of headers and payload
+        {
+            UDPSocket receiver, sender;
+            receiver.bind(Address("127.0.0.1", 0));
+            const Address destination = receiver.local_address();
+            const Buffer payload = string(1000, 'x');
+
+            size_t before = 0;
+            for (size_t i = 0; i < 101; i++) {
+                if (i == 1) {
+                    before = allocations;
+                }
+                TCPSegment seg;
+                seg.header().ack = true;
+                seg.payload() = payload;
+
+                InternetDatagram dgram;
+                dgram.header().len = dgram.header().hlen * 4 + seg.header().doff * 4 + payload.size();
+                dgram.payload() = seg.serialize(dgram.header().pseudo_cksum());
+                sender.sendto(destination, dgram.serialize());
+                receiver.recv();
+            }
+            if (allocations != before) {
+                throw runtime_error(to_string(allocations - before) + " allocations sending 100 segments");
+            }
+        }
+
+        // a Buffer can outlive the thread that allocated it, and be freed on another one
+        {
+            Buffer survivor;
+            thread producer([&] {
+                survivor = Buffer::allocate(10);
+                memcpy(survivor.prepend(5), "hello", 5);
+            });
+            producer.join();
+            if (survivor.copy() != "hello") {
+                throw runtime_error("Buffer changed when its thread exited");
+            }
+        }
+
+        // once shared, a Buffer can be copied on two threads at once, and its block is freed exactly once
+        {
+            Buffer shared = Buffer::allocate(Buffer::TINY_BLOCK);
+            char *const block = shared.prepend(5);
+            memcpy(block, "hello", 5);
+            shared.share_between_threads();
+
+            auto copy_many = [&] {
+                for (size_t i = 0; i < 100'000; i++) {
+                    const Buffer copy = shared;
+                    if (copy.size() != 5) {
+                        abort();
+                    }
+                }
+            };
+            thread other(copy_many);
+            copy_many();
+            other.join();
+
+            shared = Buffer{};
+            if (Buffer::allocate(Buffer::TINY_BLOCK).prepend(5) != block) {
+                throw runtime_error("shared Buffer's block wasn't freed once, back to this thread's pool");
+            }
+        }
+    } catch (const exception &e) {
+        cerr << "Exception: " << e.what() << endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -13,6 +13,7 @@
 #include <optional>
 #include <sstream>
 #include <string>
+#include <vector>
 
 struct ReceiverTestStep {
     virtual std::string to_string() const { return "ReceiverTestStep"; }
@@ -68,6 +69,30 @@ struct ExpectAckno : public ReceiverExpectation {
     }
 };
 
+struct ExpectSACK : public ReceiverExpectation {
+    std::vector<SACKBlock> _blocks;
+
+    ExpectSACK(std::vector<SACKBlock> blocks) : _blocks(std::move(blocks)) {}
+
+    static std::string to_string(const std::vector<SACKBlock> &blocks) {
+        std::ostringstream ss;
+        for (const auto &block : blocks) {
+            ss << "[" << block.begin.raw_value() << ", " << block.end.raw_value() << ") ";
+        }
+        return ss.str();
+    }
+
+    std::string description() const { return "SACK blocks " + to_string(_blocks); }
+
+    void execute(TCPReceiver &receiver) const {
+        const auto blocks = receiver.sack_blocks();
+        if (blocks != _blocks) {
+            throw ReceiverExpectationViolation("The TCPReceiver reported SACK blocks `" + to_string(blocks) +
+                                               "`, but they were expected to be `" + to_string(_blocks) + "`");
+        }
+    }
+};
+
 struct ExpectWindow : public ReceiverExpectation {
     size_t _window;
 
@@ -0,0 +1,209 @@
+#include "sender_harness.hh"
+#include "wrapping_integers.hh"
+
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <string>
+
+using namespace std;
+
+int main() {
+    try {
+        auto rd = get_random_generator();
+
+        {
+            TCPConfig cfg;
+            WrappingInt32 isn(rd());
+            cfg.fixed_isn = isn;
+            cfg.congestion_control = TCPConfig::CongestionControl::NewReno;
+
+            // initial window is 4 segments of 1000 bytes; each ACK in slow start opens it by one segment
+            TCPSenderTestHarness test{"NewReno slow start", cfg};
+            test.execute(ExpectSegment{}.with_no_flags().with_syn(true).with_payload_size(0).with_seqno(isn));
+            test.execute(AckReceived{WrappingInt32{isn + 1}}.with_win(20000));
+            test.execute(WriteBytes{string(8000, 'x')});
+            for (unsigned int i = 0; i < 4; i++) {
+                test.execute(ExpectSegment{}.with_payload_size(1000).with_seqno(isn + 1 + 1000 * i));
+            }
+            test.execute(ExpectNoSegment{});
+            test.execute(ExpectBytesInFlight{4000});
+            test.execute(AckReceived{WrappingInt32{isn + 1001}}.with_win(20000));
+            test.execute(ExpectSegment{}.with_payload_size(1000).with_seqno(isn + 4001));
+            test.execute(ExpectSegment{}.with_payload_size(1000).with_seqno(isn + 5001));
+            test.execute(ExpectNoSegment{});
+            test.execute(ExpectBytesInFlight{5000});
+        }
+
+        {
+            TCPConfig cfg;
+            WrappingInt32 isn(rd());
+            cfg.fixed_isn = isn;
+            cfg.rt_timeout = 1000;
+            cfg.congestion_control = TCPConfig::CongestionControl::NewReno;
+
+            // timeout: ssthresh = 4000 / 2, cwnd = 1000
+            TCPSenderTestHarness test{"NewReno timeout collapses the window", cfg};
+            test.execute(ExpectSegment{}.with_no_flags().with_syn(true).with_payload_size(0).with_seqno(isn));
+            test.execute(AckReceived{WrappingInt32{isn + 1}}.with_win(20000));
+            test.execute(WriteBytes{string(8000, 'x')});
+            for (unsigned int i = 0; i < 4; i++) {
+                test.execute(ExpectSegment{}.with_payload_size(1000).with_seqno(isn + 1 + 1000 * i));
+            }
+            test.execute(Tick{1000});
+            test.execute(ExpectSegment{}.with_payload_size(1000).with_seqno(isn + 1));
+            test.execute(ExpectNoSegment{});
+            // slow start back up to ssthresh: cwnd = 2000 is less than the 3000 still in flight
+            test.execute(AckReceived{WrappingInt32{isn + 1001}}.with_win(20000));
+            test.execute(ExpectNoSegment{});
+            // congestion avoidance: 3000 acked bytes cover the 2000-byte window, which grows by one segment
+            test.execute(AckReceived{WrappingInt32{isn + 4001}}.with_win(20000));
+            for (unsigned int i = 0; i < 3; i++) {
+                test.execute(ExpectSegment{}.with_payload_size(1000).with_seqno(isn + 4001 + 1000 * i));
+            }
+            test.execute(ExpectNoSegment{});
+        }
+
+        {
+            TCPConfig cfg;
+            WrappingInt32 isn(rd());
+            cfg.fixed_isn = isn;
+            cfg.rt_timeout = 1000;
+            cfg.congestion_control = TCPConfig::CongestionControl::Cubic;
+
+            // timeout: ssthresh = 0.7 * 4000, cwnd = 1000
+            TCPSenderTestHarness test{"CUBIC timeout reduces ssthresh by beta", cfg};
+            test.execute(ExpectSegment{}.with_no_flags().with_syn(true).with_payload_size(0).with_seqno(isn));
+            test.execute(AckReceived{WrappingInt32{isn + 1}}.with_win(20000));
+            test.execute(WriteBytes{string(8000, 'x')});
+            for (unsigned int i = 0; i < 4; i++) {
+                test.execute(ExpectSegment{}.with_payload_size(1000).with_seqno(isn + 1 + 1000 * i));
+            }
+            test.execute(ExpectNoSegment{});
+            test.execute(Tick{1000});
+            test.execute(ExpectSegment{}.with_payload_size(1000).with_seqno(isn + 1));
+            test.execute(AckReceived{WrappingInt32{isn + 1001}}.with_win(20000));
+            test.execute(ExpectNoSegment{});
+            // still in slow start (cwnd = 2000 < 2800), so the window opens by one segment
+            test.execute(AckReceived{WrappingInt32{isn + 4001}}.with_win(20000));
+            for (unsigned int i = 0; i < 3; i++) {
+                test.execute(ExpectSegment{}.with_payload_size(1000).with_seqno(isn + 4001 + 1000 * i));
+            }
+            test.execute(ExpectNoSegment{});
+            test.execute(ExpectBytesInFlight{3000});
+        }
+
+        {
+            TCPConfig cfg;
+            WrappingInt32 isn(rd());
+            cfg.fixed_isn = isn;
+            cfg.congestion_control = TCPConfig::CongestionControl::NewReno;
+
+            TCPSenderTestHarness test{"Fast retransmit and NewReno fast recovery", cfg};
+            test.execute(ExpectSegment{}.with_no_flags().with_syn(true).with_payload_size(0).with_seqno(isn));
+            test.execute(AckReceived{WrappingInt32{isn + 1}}.with_win(20000));
+            test.execute(WriteBytes{string(10000, 'x')});
+            for (unsigned int i = 0; i < 4; i++) {
+                test.execute(ExpectSegment{}.with_payload_size(1000).with_seqno(isn + 1 + 1000 * i));
+            }
+            // the first segment is lost; the other three each bring back a duplicate ACK
+            test.execute(AckReceived{WrappingInt32{isn + 1}}.with_win(20000));
+            test.execute(AckReceived{WrappingInt32{isn + 1}}.with_win(20000));
+            test.execute(ExpectNoSegment{});
+            // third duplicate: retransmit, ssthresh = 2000, cwnd = 2000 + 3 * 1000 leaves room for one new segment
+            test.execute(AckReceived{WrappingInt32{isn + 1}}.with_win(20000));
+            test.execute(ExpectSegment{}.with_payload_size(1000).with_seqno(isn + 1));
+            test.execute(ExpectSegment{}.with_payload_size(1000).with_seqno(isn + 4001));
+            test.execute(ExpectNoSegment{});
+            // partial ACK: the second segment was lost too, so resend it right away
+            test.execute(AckReceived{WrappingInt32{isn + 1001}}.with_win(20000));
+            test.execute(ExpectSegment{}.with_payload_size(1000).with_seqno(isn + 1001));
+            test.execute(ExpectSegment{}.with_payload_size(1000).with_seqno(isn + 5001));
+            test.execute(ExpectNoSegment{});
+            // full ACK ends recovery with cwnd = ssthresh
+            test.execute(AckReceived{WrappingInt32{isn + 6001}}.with_win(20000));
+            test.execute(ExpectSegment{}.with_payload_size(1000).with_seqno(isn + 6001));
+            test.execute(ExpectSegment{}.with_payload_size(1000).with_seqno(isn + 7001));
+            test.execute(ExpectNoSegment{});
+        }
+
+        {
+            TCPConfig cfg;
+            WrappingInt32 isn(rd());
+            cfg.fixed_isn = isn;
+            cfg.congestion_control = TCPConfig::CongestionControl::NewReno;
+
+            TCPSenderTestHarness test{"SACK recovery from two losses in one window", cfg};
+            test.execute(ExpectSegment{}.with_no_flags().with_syn(true).with_payload_size(0).with_seqno(isn));
+            test.execute(AckReceived{WrappingInt32{isn + 1}}.with_win(20000));
+            test.execute(WriteBytes{string(10000, 'x')});
+            for (unsigned int i = 0; i < 4; i++) {
+                test.execute(ExpectSegment{}.with_payload_size(1000).with_seqno(isn + 1 + 1000 * i));
+            }
+            test.execute(AckReceived{WrappingInt32{isn + 1001}}.with_win(20000));
+            test.execute(AckReceived{WrappingInt32{isn + 2001}}.with_win(20000));
+            for (unsigned int i = 0; i < 4; i++) {
+                test.execute(ExpectSegment{}.with_payload_size(1000).with_seqno(isn + 4001 + 1000 * i));
+            }
+            test.execute(ExpectNoSegment{});
+
+            // the segments at 2001 and 4001 are lost
+            const auto sack = [&](uint32_t begin, uint32_t end) { return SACKBlock{isn + begin, isn + end}; };
+            test.execute(AckReceived{WrappingInt32{isn + 2001}}.with_win(20000).with_sack({sack(3001, 4001)}));
+            test.execute(
+                AckReceived{WrappingInt32{isn + 2001}}.with_win(20000).with_sack({sack(5001, 6001), sack(3001, 4001)}));
+            test.execute(ExpectNoSegment{});
+            // three segments SACKed above 2001: it's lost; ssthresh = cwnd = 3000, and the pipe is full
+            test.execute(
+                AckReceived{WrappingInt32{isn + 2001}}.with_win(20000).with_sack({sack(5001, 7001), sack(3001, 4001)}));
+            test.execute(ExpectSegment{}.with_payload_size(1000).with_seqno(isn + 2001));
+            test.execute(ExpectNoSegment{});
+            // now 4001 is lost too; resend it without waiting for a partial ACK, then send new data
+            test.execute(
+                AckReceived{WrappingInt32{isn + 2001}}.with_win(20000).with_sack({sack(5001, 8001), sack(3001, 4001)}));
+            test.execute(ExpectSegment{}.with_payload_size(1000).with_seqno(isn + 4001));
+            test.execute(ExpectSegment{}.with_payload_size(1000).with_seqno(isn + 8001));
+            test.execute(ExpectNoSegment{});
+            // everything up to the recovery point: cwnd = min(ssthresh, flight size + MSS)
+            test.execute(AckReceived{WrappingInt32{isn + 8001}}.with_win(20000));
+            test.execute(ExpectSegment{}.with_payload_size(1000).with_seqno(isn + 9001));
+            test.execute(ExpectNoSegment{});
+        }
+
+        {
+            TCPConfig cfg;
+            WrappingInt32 isn(rd());
+            cfg.fixed_isn = isn;
+            cfg.congestion_control = TCPConfig::CongestionControl::NewReno;
+
+            TCPSenderTestHarness test{"SACK resends everything outstanding after a timeout", cfg};
+            test.execute(ExpectSegment{}.with_no_flags().with_syn(true).with_payload_size(0).with_seqno(isn));
+            test.execute(AckReceived{WrappingInt32{isn + 1}}.with_win(20000));
+            test.execute(WriteBytes{string(4000, 'x')});
+            for (unsigned int i = 0; i < 4; i++) {
+                test.execute(ExpectSegment{}.with_payload_size(1000).with_seqno(isn + 1 + 1000 * i));
+            }
+            const auto sack = [&](uint32_t begin, uint32_t end) { return SACKBlock{isn + begin, isn + end}; };
+            test.execute(AckReceived{WrappingInt32{isn + 1001}}.with_win(20000).with_sack({sack(2001, 3001)}));
+            test.execute(ExpectNoSegment{});
+
+            // the timeout forgets the SACKed segment (the receiver may have dropped it), and cwnd = 1 MSS
+            test.execute(Tick{1000});
+            test.execute(ExpectSegment{}.with_payload_size(1000).with_seqno(isn + 1001));
+            test.execute(ExpectNoSegment{});
+            // slow start: cwnd = 2000, and the rest of what was outstanding goes out without another timeout
+            test.execute(AckReceived{WrappingInt32{isn + 2001}}.with_win(20000));
+            test.execute(ExpectSegment{}.with_payload_size(1000).with_seqno(isn + 2001));
+            test.execute(ExpectSegment{}.with_payload_size(1000).with_seqno(isn + 3001));
+            test.execute(ExpectNoSegment{});
+            test.execute(AckReceived{WrappingInt32{isn + 4001}}.with_win(20000));
+            test.execute(ExpectNoSegment{});
+        }
+    } catch (const exception &e) {
+        cerr << e.what() << endl;
+        return 1;
+    }
+
+    return EXIT_SUCCESS;
+}
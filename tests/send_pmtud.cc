@@ -0,0 +1,81 @@
+#include "sender_harness.hh"
+#include "wrapping_integers.hh"
+
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <string>
+
+using namespace std;
+
+int main() {
+    try {
+        auto rd = get_random_generator();
+
+        {
+            TCPConfig cfg;
+            WrappingInt32 isn(rd());
+            cfg.fixed_isn = isn;
+            cfg.mss = 1460;
+            cfg.pmtu_discovery = true;
+
+            // segments start out at MAX_PAYLOAD_SIZE; the first probe tries the full MSS
+            TCPSenderTestHarness test{"Acknowledged probe raises the segment size", cfg};
+            test.execute(ExpectSegment{}.with_no_flags().with_syn(true).with_payload_size(0).with_seqno(isn));
+            test.execute(AckReceived{WrappingInt32{isn + 1}}.with_win(20000));
+            test.execute(WriteBytes{string(5000, 'x')});
+            test.execute(ExpectSegment{}.with_payload_size(1460).with_seqno(isn + 1));
+            for (unsigned int i = 0; i < 3; i++) {
+                test.execute(ExpectSegment{}.with_payload_size(1000).with_seqno(isn + 1461 + 1000 * i));
+            }
+            test.execute(ExpectSegment{}.with_payload_size(540).with_seqno(isn + 4461));
+            test.execute(ExpectNoSegment{});
+            test.execute(AckReceived{WrappingInt32{isn + 5001}}.with_win(20000));
+            test.execute(WriteBytes{string(3000, 'y')});
+            test.execute(ExpectSegment{}.with_payload_size(1460).with_seqno(isn + 5001));
+            test.execute(ExpectSegment{}.with_payload_size(1460).with_seqno(isn + 6461));
+            test.execute(ExpectSegment{}.with_payload_size(80).with_seqno(isn + 7921));
+            test.execute(ExpectNoSegment{});
+        }
+
+        {
+            TCPConfig cfg;
+            WrappingInt32 isn(rd());
+            cfg.fixed_isn = isn;
+            cfg.rt_timeout = 1000;
+            cfg.mss = 1460;
+            cfg.pmtu_discovery = true;
+
+            TCPSenderTestHarness test{"Lost probe is resent in smaller segments and the search bisects", cfg};
+            test.execute(ExpectSegment{}.with_no_flags().with_syn(true).with_payload_size(0).with_seqno(isn));
+            test.execute(AckReceived{WrappingInt32{isn + 1}}.with_win(20000));
+            test.execute(WriteBytes{string(5000, 'x')});
+            test.execute(ExpectSegment{}.with_payload_size(1460).with_seqno(isn + 1));
+            for (unsigned int i = 0; i < 4; i++) {
+                test.execute(ExpectSegment{});
+            }
+            test.execute(Tick{1000});
+            test.execute(ExpectSegment{}.with_payload_size(1000).with_seqno(isn + 1));
+            test.execute(ExpectSegment{}.with_payload_size(460).with_seqno(isn + 1001));
+            test.execute(ExpectNoSegment{});
+            // a lost probe isn't a congestion timeout: the RTO doesn't back off
+            test.execute(Tick{999});
+            test.execute(ExpectNoSegment{});
+            test.execute(Tick{1});
+            test.execute(ExpectSegment{}.with_payload_size(1000).with_seqno(isn + 1));
+            test.execute(AckReceived{WrappingInt32{isn + 5001}}.with_win(20000));
+            // next probe: halfway between 1000 and 1460
+            test.execute(WriteBytes{string(3000, 'y')});
+            test.execute(ExpectSegment{}.with_payload_size(1230).with_seqno(isn + 5001));
+            test.execute(ExpectSegment{}.with_payload_size(1000).with_seqno(isn + 6231));
+            test.execute(ExpectSegment{}.with_payload_size(770).with_seqno(isn + 7231));
+            test.execute(ExpectNoSegment{});
+        }
+    } catch (const exception &e) {
+        cerr << e.what() << endl;
+        return 1;
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -105,6 +105,34 @@ int main() {
             test.execute(Tick{1}.with_max_retx_exceeded(true));
         }
 
+        // without congestion control, the sender still resends what the SACK blocks show lost
+        {
+            TCPConfig cfg;
+            WrappingInt32 isn(rd());
+            cfg.fixed_isn = isn;
+
+            TCPSenderTestHarness test{"SACK without congestion control", cfg};
+            test.execute(ExpectSegment{}.with_no_flags().with_syn(true).with_payload_size(0).with_seqno(isn));
+            test.execute(AckReceived{WrappingInt32{isn + 1}}.with_win(5000));
+            test.execute(WriteBytes{string(5000, 'x')});
+            for (unsigned int i = 0; i < 5; i++) {
+                test.execute(ExpectSegment{}.with_payload_size(1000).with_seqno(isn + 1 + 1000 * i));
+            }
+
+            // the segment at 1001 is lost once three segments above it have been SACKed, and is resent once
+            const auto sack = [&](uint32_t begin, uint32_t end) { return SACKBlock{isn + begin, isn + end}; };
+            test.execute(AckReceived{WrappingInt32{isn + 1001}}.with_win(5000).with_sack({sack(2001, 4001)}));
+            test.execute(ExpectNoSegment{});
+            test.execute(AckReceived{WrappingInt32{isn + 1001}}.with_win(5000).with_sack({sack(2001, 5001)}));
+            test.execute(ExpectSegment{}.with_payload_size(1000).with_seqno(isn + 1001));
+            test.execute(ExpectNoSegment{});
+            test.execute(AckReceived{WrappingInt32{isn + 1001}}.with_win(5000).with_sack({sack(2001, 5001)}));
+            test.execute(ExpectNoSegment{});
+            test.execute(AckReceived{WrappingInt32{isn + 5001}}.with_win(5000));
+            test.execute(ExpectNoSegment{});
+            test.execute(ExpectBytesInFlight{0});
+        }
+
     } catch (const exception &e) {
         cerr << e.what() << endl;
         return 1;
@@ -0,0 +1,131 @@
+#include "sender_harness.hh"
+#include "wrapping_integers.hh"
+
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <optional>
+#include <stdexcept>
+#include <string>
+
+using namespace std;
+
+int main() {
+    try {
+        auto rd = get_random_generator();
+
+        {
+            TCPConfig cfg;
+            WrappingInt32 isn(rd());
+            cfg.fixed_isn = isn;
+            cfg.rt_timeout = 1000;
+            cfg.adaptive_rto = true;
+            cfg.min_rto = 10;
+
+            // first sample of 100ms: SRTT = 100, RTTVAR = 50, so RTO = 100 + 4 * 50
+            TCPSenderTestHarness test{"RTO adapts to the first RTT sample", cfg};
+            test.execute(ExpectSegment{}.with_no_flags().with_syn(true).with_payload_size(0).with_seqno(isn));
+            test.execute(Tick{100});
+            test.execute(AckReceived{WrappingInt32{isn + 1}});
+            test.execute(WriteBytes{"abcd"});
+            test.execute(ExpectSegment{}.with_payload_size(4).with_data("abcd").with_seqno(isn + 1));
+            test.execute(Tick{299});
+            test.execute(ExpectNoSegment{});
+            test.execute(Tick{1});
+            test.execute(ExpectSegment{}.with_payload_size(4).with_data("abcd").with_seqno(isn + 1));
+        }
+
+        {
+            TCPConfig cfg;
+            WrappingInt32 isn(rd());
+            cfg.fixed_isn = isn;
+            cfg.rt_timeout = 1000;
+            cfg.adaptive_rto = true;
+            cfg.min_rto = 10;
+
+            // the ACK can't tell which transmission it is for, so it isn't sampled, and the RTO stays backed off
+            TCPSenderTestHarness test{"Karn's rule: no RTT sample from a retransmitted segment", cfg};
+            test.execute(ExpectSegment{}.with_no_flags().with_syn(true).with_payload_size(0).with_seqno(isn));
+            test.execute(Tick{1000});
+            test.execute(ExpectSegment{}.with_no_flags().with_syn(true).with_payload_size(0).with_seqno(isn));
+            test.execute(Tick{5});
+            test.execute(AckReceived{WrappingInt32{isn + 1}});
+            test.execute(WriteBytes{"abcd"});
+            test.execute(ExpectSegment{}.with_payload_size(4).with_data("abcd").with_seqno(isn + 1));
+            test.execute(Tick{1999});
+            test.execute(ExpectNoSegment{});
+            test.execute(Tick{1});
+            test.execute(ExpectSegment{}.with_payload_size(4).with_data("abcd").with_seqno(isn + 1));
+        }
+
+        {
+            TCPConfig cfg;
+            WrappingInt32 isn(rd());
+            cfg.fixed_isn = isn;
+            cfg.rt_timeout = 1000;
+            cfg.adaptive_rto = true;
+            cfg.min_rto = 10;
+
+            // SRTT = 10, RTTVAR = 5, so RTO = 30
+            TCPSenderTestHarness test{"Karn's rule: no RTT sample from an ACK that covers a retransmission", cfg};
+            test.execute(ExpectSegment{}.with_no_flags().with_syn(true).with_payload_size(0).with_seqno(isn));
+            test.execute(Tick{10});
+            test.execute(AckReceived{WrappingInt32{isn + 1}}.with_win(4000));
+            test.execute(WriteBytes{string(3000, 'x')});
+            for (unsigned int i = 0; i < 3; i++) {
+                test.execute(ExpectSegment{}.with_payload_size(1000).with_seqno(isn + 1 + 1000 * i));
+            }
+            test.execute(Tick{30});
+            test.execute(ExpectSegment{}.with_payload_size(1000).with_seqno(isn + 1));
+
+            // the later segments weren't resent, but their 40ms includes the wait for the timeout
+            test.execute(Tick{10});
+            test.execute(AckReceived{WrappingInt32{isn + 3001}}.with_win(4000));
+            test.execute(WriteBytes{"abcd"});
+            test.execute(ExpectSegment{}.with_payload_size(4).with_data("abcd").with_seqno(isn + 3001));
+            test.execute(Tick{59});
+            test.execute(ExpectNoSegment{});
+            test.execute(Tick{1});
+            test.execute(ExpectSegment{}.with_payload_size(4).with_data("abcd").with_seqno(isn + 3001));
+
+            // a valid sample of 10ms replaces the backed-off RTO: RTTVAR = 3.75, so RTO = 25
+            test.execute(AckReceived{WrappingInt32{isn + 3005}}.with_win(4000));
+            test.execute(WriteBytes{"efgh"});
+            test.execute(ExpectSegment{}.with_payload_size(4).with_data("efgh").with_seqno(isn + 3005));
+            test.execute(Tick{10});
+            test.execute(AckReceived{WrappingInt32{isn + 3009}}.with_win(4000));
+            test.execute(WriteBytes{"ijkl"});
+            test.execute(ExpectSegment{}.with_payload_size(4).with_data("ijkl").with_seqno(isn + 3009));
+            test.execute(Tick{24});
+            test.execute(ExpectNoSegment{});
+            test.execute(Tick{1});
+            test.execute(ExpectSegment{}.with_payload_size(4).with_data("ijkl").with_seqno(isn + 3009));
+        }
+
+        {
+            TCPConfig cfg;
+            WrappingInt32 isn(rd());
+            cfg.fixed_isn = isn;
+            cfg.rt_timeout = 1000;
+            cfg.adaptive_rto = true;
+            cfg.min_rto = 50;
+
+            TCPSenderTestHarness test{"Adaptive RTO is no lower than min_rto", cfg};
+            test.execute(ExpectSegment{}.with_no_flags().with_syn(true).with_payload_size(0).with_seqno(isn));
+            test.execute(Tick{2});
+            test.execute(AckReceived{WrappingInt32{isn + 1}});
+            test.execute(WriteBytes{"abcd"});
+            test.execute(ExpectSegment{}.with_payload_size(4).with_data("abcd").with_seqno(isn + 1));
+            test.execute(Tick{49});
+            test.execute(ExpectNoSegment{});
+            test.execute(Tick{1});
+            test.execute(ExpectSegment{}.with_payload_size(4).with_data("abcd").with_seqno(isn + 1));
+        }
+    } catch (const exception &e) {
+        cerr << e.what() << endl;
+        return 1;
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -121,6 +121,7 @@ struct ExpectSegment : public TCPExpectation {
     std::optional<WrappingInt32> seqno{};
     std::optional<WrappingInt32> ackno{};
     std::optional<uint16_t> win{};
+    std::optional<std::optional<uint8_t>> wscale{};
     std::optional<size_t> payload_size{};
     std::optional<std::string> data{};
 
@@ -171,6 +172,11 @@ struct ExpectSegment : public TCPExpectation {
         return *this;
     }
 
+    ExpectSegment &with_wscale(std::optional<uint8_t> wscale_) {
+        wscale = wscale_;
+        return *this;
+    }
+
     ExpectSegment &with_payload_size(size_t payload_size_) {
         payload_size = payload_size_;
         return *this;
@@ -202,6 +208,9 @@ struct ExpectSegment : public TCPExpectation {
         if (win.has_value()) {
             o << "win=" << win.value() << ",";
         }
+        if (wscale.has_value()) {
+            o << "wscale=" << (wscale->has_value() ? std::to_string(wscale->value()) : "none") << ",";
+        }
         if (seqno.has_value()) {
             o << "seqno=" << seqno.value() << ",";
         }
@@ -248,6 +257,10 @@ struct ExpectSegment : public TCPExpectation {
         if (win.has_value() and seg.header().win != win.value()) {
             throw SegmentExpectationViolation::violated_field("win", win.value(), seg.header().win);
         }
+        if (wscale.has_value() and seg.header().wscale != wscale.value()) {
+            throw SegmentExpectationViolation("segment sent with the wrong window-scale option: " +
+                                              seg.header().summary());
+        }
         if (payload_size.has_value() and seg.payload().size() != payload_size.value()) {
             throw SegmentExpectationViolation::violated_field(
                 "payload_size", payload_size.value(), seg.payload().size());
@@ -390,6 +403,8 @@ struct SendSegment : public TCPAction {
     WrappingInt32 seqno{0};
     WrappingInt32 ackno{0};
     uint16_t win{0};
+    std::optional<uint16_t> mss{};
+    std::optional<uint8_t> wscale{};
     size_t payload_size{0};
     std::string data{};
 
@@ -403,6 +418,8 @@ struct SendSegment : public TCPAction {
         seqno = seg.header().seqno;
         ackno = seg.header().ackno;
         win = seg.header().win;
+        mss = seg.header().mss;
+        wscale = seg.header().wscale;
         data = seg.payload();
     }
 
@@ -445,6 +462,16 @@ struct SendSegment : public TCPAction {
         return *this;
     }
 
+    SendSegment &with_mss(uint16_t mss_) {
+        mss = mss_;
+        return *this;
+    }
+
+    SendSegment &with_wscale(uint8_t wscale_) {
+        wscale = wscale_;
+        return *this;
+    }
+
     SendSegment &with_payload_size(size_t payload_size_) {
         payload_size = payload_size_;
         return *this;
@@ -466,6 +493,9 @@ struct SendSegment : public TCPAction {
         data_hdr.ackno = ackno;
         data_hdr.seqno = seqno;
         data_hdr.win = win;
+        data_hdr.mss = mss;
+        data_hdr.wscale = wscale;
+        data_hdr.doff = (TCPHeader::LENGTH + data_hdr.options_length()) / 4;
         return data_seg;
     }
 
@@ -559,6 +589,15 @@ struct Listen : public TCPAction {
     void execute(TCPTestHarness &) const {}
 };
 
+struct Cork : public TCPAction {
+    bool cork;
+
+    Cork(const bool cork_) : cork(cork_) {}
+
+    std::string description() const { return cork ? "cork" : "uncork"; }
+    void execute(TCPTestHarness &harness) const { cork ? harness._fsm.cork() : harness._fsm.uncork(); }
+};
+
 struct Close : public TCPAction {
     std::string description() const { return "close"; }
     void execute(TCPTestHarness &harness) const { harness._fsm.end_input_stream(); }
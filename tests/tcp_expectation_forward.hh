@@ -36,6 +36,7 @@ struct Write;
 struct Tick;
 struct Connect;
 struct Listen;
+struct Cork;
 struct Close;
 
 class TCPExpectationViolation : public std::runtime_error {
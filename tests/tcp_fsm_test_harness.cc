@@ -110,7 +110,7 @@ void TCPTestHarness::send_syn(const WrappingInt32 seqno, const optional<Wrapping
     if (ackno.has_value()) {
         step.with_ack(true).with_ackno(ackno.value());
     }
-    step.with_syn(true).with_seqno(seqno).with_win(DEFAULT_TEST_WINDOW);
+    step.with_syn(true).with_seqno(seqno).with_win(DEFAULT_TEST_WINDOW).with_mss(TCPConfig::MAX_PAYLOAD_SIZE);
     execute(step);
 }
 
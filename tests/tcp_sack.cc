@@ -0,0 +1,93 @@
+#include "receiver_harness.hh"
+#include "tcp_header.hh"
+#include "tcp_segment.hh"
+#include "wrapping_integers.hh"
+
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+
+using namespace std;
+
+int main() {
+    try {
+        auto rd = get_random_generator();
+
+        // options survive a serialize/parse round trip, and doff has to make room for them
+        {
+            const uint32_t isn = uniform_int_distribution<uint32_t>{0, UINT32_MAX}(rd);
+            TCPSegment seg;
+            seg.header().ack = true;
+            seg.header().sack_permitted = true;
+            seg.header().sack = {{WrappingInt32{isn + 100}, WrappingInt32{isn + 200}},
+                                 {WrappingInt32{isn + 300}, WrappingInt32{isn + 400}}};
+            seg.payload() = string("hello");
+
+            bool threw = false;
+            try {
+                seg.serialize();
+            } catch (const runtime_error &) {
+                threw = true;
+            }
+            if (not threw) {
+                throw runtime_error("serialized options that don't fit in doff");
+            }
+
+            // 4 (SACK permitted) + 2 + 2 + 16 (two SACK blocks) = 24 bytes of options
+            if (seg.header().options_length() != 24) {
+                throw runtime_error("wrong options length " + to_string(seg.header().options_length()));
+            }
+            seg.header().doff = (TCPHeader::LENGTH + seg.header().options_length()) / 4;
+
+            TCPSegment parsed;
+            if (parsed.parse(seg.serialize().concatenate()) != ParseResult::NoError) {
+                throw runtime_error("failed to parse a segment with options");
+            }
+            if (not(parsed.header() == seg.header()) or parsed.payload().copy() != "hello") {
+                throw runtime_error("options didn't survive the round trip: " + parsed.header().summary());
+            }
+        }
+
+        // unknown options are skipped
+        {
+            TCPSegment seg;
+            seg.header().doff = 9;
+            string header = seg.header().serialize();
+            // NOP, timestamps (kind 8, length 10), SACK permitted, EOL
+            const string options = {1, 8, 10, 1, 2, 3, 4, 5, 6, 7, 8, 4, 2, 0, 0, 0};
+            header.replace(TCPHeader::LENGTH, options.size(), options);
+
+            NetParser p{Buffer{string(header)}};
+            TCPHeader parsed;
+            if (parsed.parse(p) != ParseResult::NoError or not parsed.sack_permitted or not parsed.sack.empty()) {
+                throw runtime_error("failed to skip an unknown option: " + parsed.summary());
+            }
+        }
+
+        // the receiver reports its holes, most recent block first
+        {
+            const uint32_t isn = uniform_int_distribution<uint32_t>{0, UINT32_MAX}(rd);
+            TCPReceiverTestHarness test{4000};
+            test.execute(SegmentArrives{}.with_syn().with_seqno(isn).with_result(SegmentArrives::Result::OK));
+            test.execute(ExpectSACK{{}});
+            test.execute(SegmentArrives{}.with_seqno(isn + 1001).with_data(string(500, 'a')));
+            test.execute(SegmentArrives{}.with_seqno(isn + 2001).with_data(string(100, 'b')));
+            test.execute(ExpectSACK{{{WrappingInt32{isn + 2001}, WrappingInt32{isn + 2101}},
+                                     {WrappingInt32{isn + 1001}, WrappingInt32{isn + 1501}}}});
+            test.execute(SegmentArrives{}.with_seqno(isn + 1501).with_data(string(200, 'c')));
+            test.execute(ExpectSACK{{{WrappingInt32{isn + 1001}, WrappingInt32{isn + 1701}},
+                                     {WrappingInt32{isn + 2001}, WrappingInt32{isn + 2101}}}});
+            test.execute(SegmentArrives{}.with_seqno(isn + 1).with_data(string(1000, 'd')));
+            test.execute(ExpectAckno{WrappingInt32{isn + 1701}});
+            test.execute(ExpectSACK{{{WrappingInt32{isn + 2001}, WrappingInt32{isn + 2101}}}});
+        }
+    } catch (const exception &e) {
+        cerr << e.what() << endl;
+        return 1;
+    }
+
+    return EXIT_SUCCESS;
+}